@@ -22,7 +22,7 @@ namespace openlcb
 /// - the generated cdi.xml will include this data
 /// - the Simple Node Ident Info Protocol will return this data
 /// - the ACDI memory space will contain this data.
-extern const SimpleNodeStaticValues SNIP_STATIC_DATA = {
+extern constexpr SimpleNodeStaticValues SNIP_STATIC_DATA = {
     4,               "Balazs Racz", "Accessory Board 884",
     "v3", "1.01"};
 
@@ -22,7 +22,7 @@ namespace openlcb
 /// - the generated cdi.xml will include this data
 /// - the Simple Node Ident Info Protocol will return this data
 /// - the ACDI memory space will contain this data.
-extern const SimpleNodeStaticValues SNIP_STATIC_DATA = {4, "OpenMRN",
+extern constexpr SimpleNodeStaticValues SNIP_STATIC_DATA = {4, "OpenMRN",
     "Test IO Board - Tiva Connected Launchpad", "ek-tm4c1294xl", "1.01"};
 
 #define NUM_OUTPUTS 4
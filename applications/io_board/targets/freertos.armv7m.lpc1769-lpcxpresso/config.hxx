@@ -22,7 +22,7 @@ namespace openlcb
 /// - the generated cdi.xml will include this data
 /// - the Simple Node Ident Info Protocol will return this data
 /// - the ACDI memory space will contain this data.
-extern const SimpleNodeStaticValues SNIP_STATIC_DATA = {
+extern constexpr SimpleNodeStaticValues SNIP_STATIC_DATA = {
     4,               "OpenMRN", "Test IO Board - LPCXpresso LPC1769",
     "lpc1769-lpcxpresso", "1.01"};
 
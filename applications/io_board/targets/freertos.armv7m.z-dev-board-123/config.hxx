@@ -22,7 +22,7 @@ namespace openlcb
 /// - the generated cdi.xml will include this data
 /// - the Simple Node Ident Info Protocol will return this data
 /// - the ACDI memory space will contain this data.
-extern const SimpleNodeStaticValues SNIP_STATIC_DATA = {
+extern constexpr SimpleNodeStaticValues SNIP_STATIC_DATA = {
     4, "Z Systems", "LCC-DevBoard4S with Tiva 123 launchpad", "4S", "1.01"};
 
 /// Declares a repeated group of a given base group and number of repeats. The
@@ -131,6 +131,10 @@ openlcb::RefreshLoop loop(
  */
 int appl_main(int argc, char *argv[])
 {
+#ifdef HAVE_CONSTEXPR_CDI
+    // Serves the cdi.xml that the compiler rendered from config.hxx.
+    stack.use_compiled_cdi<openlcb::ConfigDef>();
+#endif
     stack.create_config_file_if_needed(cfg.seg().internal_config(), openlcb::CANONICAL_VERSION, openlcb::CONFIG_FILE_SIZE);
     // Connects to a TCP hub on the internet.
     //stack.connect_tcp_gridconnect_hub("28k.ch", 50007);
@@ -0,0 +1,552 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file load_generator.cxx
+ *
+ * Synthesizes a configurable mix of OpenLCB traffic on a CAN hub and measures
+ * how fast the node(s) under test respond.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include "load_generator.hxx"
+
+#include <algorithm>
+
+#include "openlcb/TractionDefs.hxx"
+#include "utils/StringPrintf.hxx"
+#include "utils/gc_format.h"
+
+namespace loadgen
+{
+
+unsigned parse_replay(
+    const std::string &text, std::vector<struct can_frame> *frames)
+{
+    unsigned count = 0;
+    size_t pos = 0;
+    while ((pos = text.find(':', pos)) != std::string::npos)
+    {
+        size_t end = text.find(';', pos);
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        std::string f = text.substr(pos + 1, end - pos - 1);
+        struct can_frame frame;
+        if (gc_format_parse(f.c_str(), &frame) == 0)
+        {
+            frames->push_back(frame);
+            ++count;
+        }
+        pos = end + 1;
+    }
+    return count;
+}
+
+LoadGenerator::LoadGenerator(CanHubFlow *hub, const LoadConfig &cfg)
+    : StateFlowBase(hub->service())
+    , cfg_(cfg)
+    , hub_(hub)
+    , rxPort_(this)
+    , timer_(this)
+    , rng_(cfg.seed)
+{
+    if (!cfg_.train)
+    {
+        cfg_.weight[OP_TRACTION] = 0;
+    }
+    if (cfg_.replay.empty())
+    {
+        cfg_.weight[OP_REPLAY] = 0;
+    }
+    if (!cfg_.num_events)
+    {
+        cfg_.weight[OP_EVENT] = 0;
+    }
+    for (unsigned i = 0; i < NUM_OPS; ++i)
+    {
+        totalWeight_ += cfg_.weight[i];
+    }
+    HASSERT(totalWeight_ && cfg_.slots && cfg_.slots < 0x100);
+    slots_.resize(cfg_.slots);
+    for (unsigned i = 0; i < cfg_.slots; ++i)
+    {
+        slots_[i].id = cfg_.source_base + i;
+        slots_[i].alias = 0xA00 + i;
+    }
+    hub_->register_port(&rxPort_);
+}
+
+StateFlowBase::Action LoadGenerator::send_cid()
+{
+    for (Slot &s : slots_)
+    {
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            uint32_t part = (s.id >> (36 - 12 * i)) & 0xfff;
+            send_frame(((0x17 - i) << 24) | (part << 12) | s.alias);
+        }
+    }
+    return sleep_and_call(&timer_, MSEC_TO_NSEC(200), STATE(send_amd));
+}
+
+StateFlowBase::Action LoadGenerator::send_amd()
+{
+    if (!error_.empty())
+    {
+        return call_immediately(STATE(finish));
+    }
+    for (Slot &s : slots_)
+    {
+        send_frame(0x10700000 | s.alias);
+        uint8_t d[6];
+        openlcb::node_id_to_data(s.id, d);
+        send_frame(0x10701000 | s.alias, d, 6);
+    }
+    return call_immediately(STATE(resolve));
+}
+
+StateFlowBase::Action LoadGenerator::resolve()
+{
+    uint8_t d[6];
+    openlcb::node_id_to_data(cfg_.target, d);
+    send_frame(0x10702000 | slots_[0].alias, d, 6);
+    if (cfg_.train)
+    {
+        openlcb::node_id_to_data(cfg_.train, d);
+        send_frame(0x10702000 | slots_[0].alias, d, 6);
+    }
+    return sleep_and_call(&timer_, SEC_TO_NSEC(1), STATE(start_load));
+}
+
+StateFlowBase::Action LoadGenerator::start_load()
+{
+    if (!targetAlias_ || (cfg_.train && !trainAlias_))
+    {
+        error_ = "Target node not found.";
+        return call_immediately(STATE(finish));
+    }
+    startTime_ = os_get_time_monotonic();
+    endTime_ = startTime_ + cfg_.duration_nsec;
+    for (unsigned i = 0; i < slots_.size(); ++i)
+    {
+        issue(i);
+    }
+    return call_immediately(STATE(tick));
+}
+
+StateFlowBase::Action LoadGenerator::tick()
+{
+    long long now = os_get_time_monotonic();
+    bool any_busy = false;
+    for (unsigned i = 0; i < slots_.size(); ++i)
+    {
+        Slot &s = slots_[i];
+        if (s.busy && now - s.start > cfg_.timeout_nsec)
+        {
+            ++stats_[s.kind].timeouts;
+            s.busy = false;
+            issue(i);
+        }
+        any_busy |= s.busy;
+    }
+    if (now >= endTime_)
+    {
+        stopping_ = true;
+        if (!any_busy || now >= endTime_ + cfg_.timeout_nsec)
+        {
+            return call_immediately(STATE(finish));
+        }
+    }
+    return sleep_and_call(&timer_, MSEC_TO_NSEC(10), STATE(tick));
+}
+
+StateFlowBase::Action LoadGenerator::finish()
+{
+    if (!lastDone_)
+    {
+        lastDone_ = os_get_time_monotonic();
+    }
+    done_->notify();
+    return exit();
+}
+
+void LoadGenerator::send_frame(uint32_t id, const uint8_t *data, unsigned len)
+{
+    auto *b = hub_->alloc();
+    struct can_frame *f = b->data()->mutable_frame();
+    SET_CAN_FRAME_ID_EFF(*f, id);
+    f->can_dlc = len;
+    if (len)
+    {
+        memcpy(f->data, data, len);
+    }
+    b->data()->skipMember_ = &rxPort_;
+    hub_->send(b);
+    ++framesSent_;
+}
+
+void LoadGenerator::send_frame(const struct can_frame &frame)
+{
+    auto *b = hub_->alloc();
+    *b->data()->mutable_frame() = frame;
+    b->data()->skipMember_ = &rxPort_;
+    hub_->send(b);
+    ++framesSent_;
+}
+
+void LoadGenerator::send_addressed(NodeAlias src, openlcb::Defs::MTI mti,
+    NodeAlias dst, const std::string &payload)
+{
+    uint8_t d[8];
+    d[0] = dst >> 8;
+    d[1] = dst & 0xff;
+    memcpy(d + 2, payload.data(), payload.size());
+    send_frame(0x19000000 | ((mti & 0xfff) << 12) | src, d,
+        payload.size() + 2);
+}
+
+void LoadGenerator::send_event(
+    NodeAlias src, openlcb::Defs::MTI mti, uint64_t event)
+{
+    uint8_t d[8];
+    for (int i = 7; i >= 0; --i)
+    {
+        d[i] = event & 0xff;
+        event >>= 8;
+    }
+    send_frame(0x19000000 | ((mti & 0xfff) << 12) | src, d, 8);
+}
+
+void LoadGenerator::issue(unsigned index)
+{
+    Slot &s = slots_[index];
+    if (stopping_)
+    {
+        return;
+    }
+    unsigned r = rng_() % totalWeight_;
+    unsigned k = 0;
+    while (r >= cfg_.weight[k])
+    {
+        r -= cfg_.weight[k++];
+    }
+    s.kind = (OpKind)k;
+    s.busy = true;
+    ++s.seq;
+    ++stats_[k].issued;
+    s.start = os_get_time_monotonic();
+    switch (s.kind)
+    {
+        case OP_EVENT:
+        {
+            // Each slot uses its own bits so that the answers can be told
+            // apart.
+            unsigned per_slot = (cfg_.num_events + slots_.size() - 1 -
+                                    index) / slots_.size();
+            if (!per_slot)
+            {
+                per_slot = 1;
+            }
+            unsigned bit = index + slots_.size() * (rng_() % per_slot);
+            s.event = cfg_.event_base + 2 * bit + (rng_() & 1);
+            send_event(
+                s.alias, openlcb::Defs::MTI_EVENT_REPORT, s.event);
+            send_event(s.alias, openlcb::Defs::MTI_CONSUMER_IDENTIFY,
+                s.event);
+            break;
+        }
+        case OP_DATAGRAM:
+        {
+            static const uint8_t get_options[] = {0x20, 0x80};
+            send_frame(0x1A000000 | (targetAlias_ << 12) | s.alias,
+                get_options, 2);
+            break;
+        }
+        case OP_TRACTION:
+        {
+            static const float speeds[] = {0, 5.5, 13, 42};
+            openlcb::Velocity v(speeds[rng_() % 4]);
+            std::string p(3, 0);
+            p[0] = openlcb::TractionDefs::REQ_SET_SPEED;
+            openlcb::speed_to_fp16(v, &p[1]);
+            send_addressed(s.alias,
+                openlcb::Defs::MTI_TRACTION_CONTROL_COMMAND, trainAlias_,
+                p);
+            p.resize(1);
+            p[0] = openlcb::TractionDefs::REQ_QUERY_SPEED;
+            send_addressed(s.alias,
+                openlcb::Defs::MTI_TRACTION_CONTROL_COMMAND, trainAlias_,
+                p);
+            break;
+        }
+        case OP_REPLAY:
+            send_frame(cfg_.replay[replayNext_]);
+            if (++replayNext_ >= cfg_.replay.size())
+            {
+                replayNext_ = 0;
+            }
+            // fall through
+        case OP_ALIAS:
+        {
+            uint8_t d[6];
+            openlcb::node_id_to_data(cfg_.target, d);
+            send_frame(0x10702000 | s.alias, d, 6);
+            aliasWaiters_.push_back({index, s.seq});
+            break;
+        }
+        default:
+            DIE("Unknown op kind");
+    }
+}
+
+void LoadGenerator::complete(unsigned index, bool error)
+{
+    Slot &s = slots_[index];
+    long long now = os_get_time_monotonic();
+    if (error)
+    {
+        ++stats_[s.kind].errors;
+    }
+    else
+    {
+        stats_[s.kind].latency.push_back((now - s.start) / 1000);
+    }
+    s.busy = false;
+    lastDone_ = now;
+    issue(index);
+}
+
+int LoadGenerator::find_slot(unsigned alias)
+{
+    unsigned index = alias - 0xA00;
+    return index < slots_.size() ? index : -1;
+}
+
+void LoadGenerator::handle_frame(const struct can_frame &f)
+{
+    ++framesReceived_;
+    uint32_t id = GET_CAN_FRAME_ID_EFF(f);
+    NodeAlias src = id & 0xfff;
+    if (find_slot(src) >= 0)
+    {
+        // Someone else is using our alias.
+        error_ = StringPrintf("Alias conflict on %03x", src);
+        stopping_ = true;
+        return;
+    }
+    if ((id >> 12) == 0x10701 && f.can_dlc == 6)
+    {
+        handle_amd(src, openlcb::data_to_node_id(f.data));
+        return;
+    }
+    if ((id & 0x08000000) == 0)
+    {
+        // CAN control frame.
+        return;
+    }
+    unsigned type = (id >> 24) & 7;
+    if (type >= 2 && type <= 5)
+    {
+        // Datagram frame.
+        int index = find_slot((id >> 12) & 0xfff);
+        if (index >= 0 && src == targetAlias_ && (type == 2 || type == 5))
+        {
+            // Last frame of the answer. Acknowledge it.
+            std::string ok;
+            send_addressed(slots_[index].alias,
+                openlcb::Defs::MTI_DATAGRAM_OK, src, ok);
+            if (slots_[index].busy && slots_[index].kind == OP_DATAGRAM)
+            {
+                complete(index);
+            }
+        }
+        return;
+    }
+    if (type != 1)
+    {
+        return;
+    }
+    unsigned mti = (id >> 12) & 0xfff;
+    if (mti & openlcb::Defs::MTI_ADDRESS_MASK)
+    {
+        if (f.can_dlc < 2)
+        {
+            return;
+        }
+        int index = find_slot(((f.data[0] & 0xf) << 8) | f.data[1]);
+        if (index < 0 || !slots_[index].busy)
+        {
+            return;
+        }
+        unsigned flags = f.data[0] >> 4;
+        if (mti == openlcb::Defs::MTI_TRACTION_CONTROL_REPLY &&
+            slots_[index].kind == OP_TRACTION &&
+            (flags == 0 || flags == 2))
+        {
+            complete(index);
+        }
+        else if (mti == openlcb::Defs::MTI_DATAGRAM_REJECTED &&
+            slots_[index].kind == OP_DATAGRAM)
+        {
+            complete(index, true);
+        }
+        else if (mti == openlcb::Defs::MTI_OPTIONAL_INTERACTION_REJECTED)
+        {
+            complete(index, true);
+        }
+        return;
+    }
+    if (f.can_dlc == 8 && src == targetAlias_ &&
+        (mti == (openlcb::Defs::MTI_CONSUMER_IDENTIFIED_VALID & 0xfff) ||
+            mti ==
+                (openlcb::Defs::MTI_CONSUMER_IDENTIFIED_INVALID & 0xfff) ||
+            mti ==
+                (openlcb::Defs::MTI_CONSUMER_IDENTIFIED_UNKNOWN & 0xfff)))
+    {
+        uint64_t event = openlcb::data_to_eventid(f.data);
+        if (event < cfg_.event_base)
+        {
+            return;
+        }
+        unsigned index = ((event - cfg_.event_base) / 2) % slots_.size();
+        Slot &s = slots_[index];
+        if (s.busy && s.kind == OP_EVENT && s.event == event)
+        {
+            complete(index);
+        }
+    }
+}
+
+void LoadGenerator::handle_amd(NodeAlias alias, NodeID node)
+{
+    if (node == cfg_.target)
+    {
+        targetAlias_ = alias;
+    }
+    if (node == cfg_.train)
+    {
+        trainAlias_ = alias;
+    }
+    if (node != cfg_.target)
+    {
+        return;
+    }
+    while (!aliasWaiters_.empty())
+    {
+        auto w = aliasWaiters_.front();
+        aliasWaiters_.pop_front();
+        Slot &s = slots_[w.first];
+        if (s.busy && s.seq == w.second &&
+            (s.kind == OP_ALIAS || s.kind == OP_REPLAY))
+        {
+            complete(w.first);
+            return;
+        }
+    }
+}
+
+/// @return a percentile of a sorted vector.
+/// @param v is the sorted vector.
+/// @param p is the percentile (0..100).
+static uint32_t percentile(const std::vector<uint32_t> &v, double p)
+{
+    if (v.empty())
+    {
+        return 0;
+    }
+    size_t i = (size_t)(p / 100 * (v.size() - 1) + 0.5);
+    return v[i];
+}
+
+std::string LoadGenerator::json_results()
+{
+    double sec = (lastDone_ - startTime_) / 1e9;
+    std::string ret = StringPrintf("{\"duration_sec\": %.3f, \"slots\": %u, "
+                                   "\"frames_sent\": %u, "
+                                   "\"frames_received\": %u, "
+                                   "\"frames_per_sec\": %.0f",
+        sec, (unsigned)slots_.size(), framesSent_, framesReceived_,
+        (framesSent_ + framesReceived_) / sec);
+    if (!error_.empty())
+    {
+        ret += StringPrintf(", \"error\": \"%s\"", error_.c_str());
+    }
+    ret += ", \"ops\": {";
+    bool first = true;
+    for (unsigned k = 0; k < NUM_OPS; ++k)
+    {
+        OpStats &st = stats_[k];
+        if (!st.issued)
+        {
+            continue;
+        }
+        std::sort(st.latency.begin(), st.latency.end());
+        ret += StringPrintf("%s\"%s\": {\"issued\": %u, \"completed\": %u, "
+                            "\"timeouts\": %u, \"errors\": %u, "
+                            "\"ops_per_sec\": %.0f, \"latency_usec\": "
+                            "{\"p50\": %u, \"p90\": %u, \"p99\": %u, "
+                            "\"max\": %u}}",
+            first ? "" : ", ", OP_NAMES[k], st.issued,
+            (unsigned)st.latency.size(), st.timeouts, st.errors,
+            st.latency.size() / sec, percentile(st.latency, 50),
+            percentile(st.latency, 90), percentile(st.latency, 99),
+            percentile(st.latency, 100));
+        first = false;
+    }
+    ret += "}}\n";
+    return ret;
+}
+
+std::string LoadGenerator::text_results()
+{
+    double sec = (lastDone_ - startTime_) / 1e9;
+    std::string ret = StringPrintf(
+        "%.1f sec, %u slots, %u frames sent, %u frames received (%.0f/sec)\n",
+        sec, (unsigned)slots_.size(), framesSent_, framesReceived_,
+        (framesSent_ + framesReceived_) / sec);
+    ret += "kind        issued    ops/sec  timeout  p50 usec  p90 usec  "
+           "p99 usec  max usec\n";
+    for (unsigned k = 0; k < NUM_OPS; ++k)
+    {
+        OpStats &st = stats_[k];
+        if (!st.issued)
+        {
+            continue;
+        }
+        std::sort(st.latency.begin(), st.latency.end());
+        ret += StringPrintf("%-10s %7u %10.0f %8u %9u %9u %9u %9u\n",
+            OP_NAMES[k], st.issued, st.latency.size() / sec,
+            st.timeouts + st.errors, percentile(st.latency, 50),
+            percentile(st.latency, 90), percentile(st.latency, 99),
+            percentile(st.latency, 100));
+    }
+    return ret;
+}
+
+} // namespace loadgen
@@ -0,0 +1,325 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file load_generator.hxx
+ *
+ * Synthesizes a configurable mix of OpenLCB traffic on a CAN hub and measures
+ * how fast the node(s) under test respond.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _APPLICATIONS_LOAD_TEST_LOAD_GENERATOR_HXX_
+#define _APPLICATIONS_LOAD_TEST_LOAD_GENERATOR_HXX_
+
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "executor/StateFlow.hxx"
+#include "openlcb/Defs.hxx"
+#include "openlcb/If.hxx"
+#include "utils/Hub.hxx"
+
+namespace loadgen
+{
+
+using openlcb::NodeAlias;
+using openlcb::NodeID;
+
+/// Kinds of requests the load generator sends. Every request ends with a
+/// message that the node under test has to answer; the time until the answer
+/// is the latency of the request.
+enum OpKind
+{
+    /// Event Report followed by an Identify Consumer for the same event;
+    /// answered by Consumer Identified.
+    OP_EVENT,
+    /// Memory config Get Options datagram; answered by the reply datagram.
+    OP_DATAGRAM,
+    /// Set Speed followed by Query Speed to a train node; answered by the
+    /// traction reply.
+    OP_TRACTION,
+    /// Alias Mapping Enquiry for the target node; answered by AMD.
+    OP_ALIAS,
+    /// Next frame from a recorded log, followed by an alias mapping enquiry as
+    /// a probe.
+    OP_REPLAY,
+    NUM_OPS
+};
+
+/// Names of the OpKind values, used on the command line and in the output.
+static const char *const OP_NAMES[NUM_OPS] = {
+    "event", "datagram", "traction", "alias", "replay"};
+
+/// Parameters of a load test run.
+struct LoadConfig
+{
+    /// Relative frequency of each request kind.
+    unsigned weight[NUM_OPS] = {4, 1, 2, 1, 0};
+    /// How many requests are outstanding at the same time. Each slot uses its
+    /// own alias (virtual source node).
+    unsigned slots = 4;
+    /// How long to generate load.
+    long long duration_nsec = SEC_TO_NSEC(5);
+    /// After how long an unanswered request counts as lost.
+    long long timeout_nsec = MSEC_TO_NSEC(500);
+    /// Seed of the random number generator.
+    unsigned seed = 1;
+    /// Node ID of the node under test.
+    NodeID target = 0;
+    /// Node ID of the train node. 0 if there is none.
+    NodeID train = 0;
+    /// First event ID the node under test consumes. Consecutive pairs of
+    /// events (on/off) belong to one bit.
+    uint64_t event_base = 0;
+    /// Number of bits (event pairs) the node under test consumes.
+    unsigned num_events = 0;
+    /// Node ID of the first source node the generator simulates.
+    NodeID source_base = 0x0501010119A0ULL;
+    /// Frames for OP_REPLAY.
+    std::vector<struct can_frame> replay;
+};
+
+/// Parses a gridconnect log for replaying. Lines without a frame are skipped.
+/// @param text is the file contents.
+/// @param frames will get the parsed frames appended.
+/// @return the number of frames parsed.
+unsigned parse_replay(
+    const std::string &text, std::vector<struct can_frame> *frames);
+
+/// Sends requests from a number of simulated source nodes to a CAN hub, keeps
+/// a fixed number of requests outstanding, and records the latency of the
+/// answers.
+///
+/// All the work is done on the executor of the hub's service, so it is
+/// serialized with the node under test when that lives on the same hub.
+class LoadGenerator : public StateFlowBase
+{
+public:
+    /// Constructor.
+    /// @param hub is where to send the traffic; also its executor is used.
+    /// @param cfg is the test configuration.
+    LoadGenerator(CanHubFlow *hub, const LoadConfig &cfg);
+
+    ~LoadGenerator()
+    {
+        hub_->unregister_port(&rxPort_);
+    }
+
+    /// Starts the test. Must be called once.
+    /// @param done will be notified when the test is over.
+    void run(Notifiable *done)
+    {
+        done_ = done;
+        start_flow(STATE(send_cid));
+    }
+
+    /// @return true if the setup failed (e.g. the target node did not
+    /// answer). Valid after the test is over.
+    bool failed()
+    {
+        return !error_.empty();
+    }
+
+    /// @return the description of the setup failure.
+    const std::string &error()
+    {
+        return error_;
+    }
+
+    /// @return the test results as a JSON object.
+    std::string json_results();
+
+    /// @return the test results in human readable form.
+    std::string text_results();
+
+private:
+    /// Statistics of one request kind.
+    struct OpStats
+    {
+        /// Number of requests sent.
+        unsigned issued = 0;
+        /// Number of requests that timed out.
+        unsigned timeouts = 0;
+        /// Number of requests that were rejected by the target.
+        unsigned errors = 0;
+        /// Latency of each answered request in usec.
+        std::vector<uint32_t> latency;
+    };
+
+    /// State of one simulated source node.
+    struct Slot
+    {
+        /// Node ID of the source node.
+        NodeID id;
+        /// Alias of the source node.
+        NodeAlias alias;
+        /// True if there is a request outstanding.
+        bool busy = false;
+        /// Kind of the outstanding request.
+        OpKind kind;
+        /// When the request was sent.
+        long long start;
+        /// Event the request is about (OP_EVENT).
+        uint64_t event;
+        /// Sequence number of the outstanding request.
+        unsigned seq = 0;
+    };
+
+    /// Receives all frames from the hub.
+    class RxPort : public CanHubPortInterface
+    {
+    public:
+        /// @param parent owning generator.
+        RxPort(LoadGenerator *parent)
+            : parent_(parent)
+        {
+        }
+
+        void send(Buffer<CanHubData> *b, unsigned priority) override
+        {
+            parent_->handle_frame(b->data()->frame());
+            b->unref();
+        }
+
+    private:
+        /// Owning generator.
+        LoadGenerator *parent_;
+    };
+
+    /// Sends the check ID frames for all slots' aliases.
+    Action send_cid();
+
+    /// Reserves the aliases and announces the source nodes.
+    Action send_amd();
+
+    /// Asks for the aliases of the target nodes.
+    Action resolve();
+
+    /// Starts all slots.
+    Action start_load();
+
+    /// Checks for timed out requests and the end of the test.
+    Action tick();
+
+    /// Notifies the caller.
+    Action finish();
+
+    /// Sends a frame to the hub.
+    /// @param id is the 29-bit CAN identifier.
+    /// @param data is the payload.
+    /// @param len is the payload length.
+    void send_frame(
+        uint32_t id, const uint8_t *data = nullptr, unsigned len = 0);
+
+    /// Sends a copy of a frame to the hub.
+    /// @param frame is the frame to send.
+    void send_frame(const struct can_frame &frame);
+
+    /// Sends an addressed message in a single frame.
+    /// @param src source alias.
+    /// @param mti is the message type.
+    /// @param dst destination alias.
+    /// @param payload is the message body, at most 6 bytes.
+    void send_addressed(NodeAlias src, openlcb::Defs::MTI mti, NodeAlias dst,
+        const std::string &payload);
+
+    /// Sends a global message with an event ID.
+    /// @param src source alias.
+    /// @param mti is the message type.
+    /// @param event is the event ID.
+    void send_event(NodeAlias src, openlcb::Defs::MTI mti, uint64_t event);
+
+    /// Sends the next request from a slot.
+    /// @param index is the slot.
+    void issue(unsigned index);
+
+    /// Records an answered request and sends the next one.
+    /// @param index is the slot.
+    /// @param error is true if the target rejected the request.
+    void complete(unsigned index, bool error = false);
+
+    /// @return the slot that has the given alias, or -1.
+    /// @param alias is the alias to look for.
+    int find_slot(unsigned alias);
+
+    /// Matches a frame from the bus to the outstanding requests.
+    /// @param f is the frame.
+    void handle_frame(const struct can_frame &f);
+
+    /// Handles an alias map definition frame.
+    /// @param alias is the source alias.
+    /// @param node is the node ID in the frame.
+    void handle_amd(NodeAlias alias, NodeID node);
+
+    /// Test parameters.
+    LoadConfig cfg_;
+    /// Where to send the traffic.
+    CanHubFlow *hub_;
+    /// Receives traffic from the hub.
+    RxPort rxPort_;
+    /// Used for the setup delays and the periodic check.
+    StateFlowTimer timer_;
+    /// Generates the request mix.
+    std::mt19937 rng_;
+    /// Sum of the weights in cfg_.
+    unsigned totalWeight_{0};
+    /// Simulated source nodes.
+    std::vector<Slot> slots_;
+    /// Slot index and sequence number of the requests waiting for an AMD.
+    std::deque<std::pair<unsigned, unsigned>> aliasWaiters_;
+    /// Statistics for each request kind.
+    OpStats stats_[NUM_OPS];
+    /// Alias of the node under test.
+    NodeAlias targetAlias_{0};
+    /// Alias of the train node.
+    NodeAlias trainAlias_{0};
+    /// Next frame to replay.
+    unsigned replayNext_{0};
+    /// True when no more requests should be sent.
+    bool stopping_{false};
+    /// Set if the test could not run.
+    std::string error_;
+    /// Number of frames sent to the hub.
+    unsigned framesSent_{0};
+    /// Number of frames received from the hub.
+    unsigned framesReceived_{0};
+    /// When the load started.
+    long long startTime_{0};
+    /// When the load should stop.
+    long long endTime_{0};
+    /// When the last request was answered.
+    long long lastDone_{0};
+    /// Notified when the test is over.
+    Notifiable *done_;
+};
+
+} // namespace loadgen
+
+#endif // _APPLICATIONS_LOAD_TEST_LOAD_GENERATOR_HXX_
@@ -0,0 +1,409 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file main.cxx
+ *
+ * Load generator and benchmark for the OpenLCB stack. Runs a node under test
+ * in the same process (or connects to a hub), sends it a mix of requests and
+ * prints throughput and latency.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <memory>
+
+#include "executor/Executor.hxx"
+#include "executor/Service.hxx"
+#include "openlcb/EventHandlerTemplates.hxx"
+#include "openlcb/SimpleNodeInfoMockUserFile.hxx"
+#include "openlcb/SimpleStack.hxx"
+#include "openlcb/TractionTrain.hxx"
+#include "os/os.h"
+#include "utils/GridConnectHub.hxx"
+#include "utils/constants.hxx"
+#include "utils/socket_listener.hxx"
+
+#include "load_generator.hxx"
+
+/// Node ID of the node under test when it runs in this process.
+static const openlcb::NodeID NODE_ID = 0x050101011990ULL;
+/// Node ID of the train node under test when it runs in this process.
+static const openlcb::NodeID TRAIN_NODE_ID = 0x050101011991ULL;
+
+const char *const openlcb::SNIP_DYNAMIC_FILENAME =
+    openlcb::MockSNIPUserFile::snip_user_file_path;
+
+namespace openlcb
+{
+const SimpleNodeStaticValues SNIP_STATIC_DATA = {
+    4, "OpenMRN", "Load test node", "No hardware here", "1.0"};
+}
+
+OVERRIDE_CONST(gc_generate_newlines, 1);
+
+const char *host = nullptr;
+int port = 12021;
+const char *device_path = nullptr;
+int export_port = 0;
+const char *output_path = nullptr;
+loadgen::LoadConfig cfg;
+
+void usage(const char *e)
+{
+    fprintf(stderr,
+        "Usage: %s [-i host] [-p port] [-d device] [-n node_id] [-T train_id] "
+        "[-e event_base] [-E num_events] [-t seconds] [-c slots] "
+        "[-m mix] [-r replay_file] [-s seed] [-l export_port] [-o output]\n\n",
+        e);
+    fprintf(stderr,
+        "Sends a mix of OpenLCB requests to a node and measures the "
+        "throughput and the latency of the answers.\n"
+        "By default the node under test (with a train node and consumed "
+        "events) runs in this process on the same CAN hub.\n\nArguments:\n");
+    fprintf(stderr,
+        "\t-i host     connects to an OpenLCB hub (GridConnect over TCP) "
+        "instead, and sends the load to the node given by -n.\n");
+    fprintf(stderr, "\t-p port     port of the hub, default 12021.\n");
+    fprintf(stderr,
+        "\t-d device   connects to a GridConnect serial/USB-CAN device "
+        "instead.\n");
+    fprintf(stderr,
+        "\t-n node_id  node ID (hex) of the remote node under test.\n");
+    fprintf(stderr,
+        "\t-T train_id node ID (hex) of the remote train node; traction "
+        "requests are skipped without it.\n");
+    fprintf(stderr,
+        "\t-e event    first consumed event ID (hex); -E is the number of "
+        "consumed on/off event pairs (default 256 for the local node).\n");
+    fprintf(stderr, "\t-t seconds  length of the test, default 5.\n");
+    fprintf(stderr,
+        "\t-c slots    number of requests outstanding at a time, default "
+        "4.\n");
+    fprintf(stderr,
+        "\t-m mix      relative weight of the request kinds, default "
+        "event=4,datagram=1,traction=2,alias=1,replay=0.\n");
+    fprintf(stderr,
+        "\t-r file     GridConnect log whose frames are replayed by the "
+        "'replay' requests (sets replay=1 unless given in -m).\n");
+    fprintf(stderr, "\t-s seed     random seed, default 1.\n");
+    fprintf(stderr,
+        "\t-l port     exports the local CAN hub on this TCP port.\n");
+    fprintf(stderr,
+        "\t-o file     writes the results as JSON to this file; '-' for "
+        "stdout.\n");
+    exit(1);
+}
+
+/// Parses the -m argument.
+/// @param arg is the argument.
+void parse_mix(char *arg)
+{
+    for (char *tok = strtok(arg, ","); tok; tok = strtok(nullptr, ","))
+    {
+        char *eq = strchr(tok, '=');
+        if (!eq)
+        {
+            usage("load_test");
+        }
+        *eq = 0;
+        unsigned k = 0;
+        while (k < loadgen::NUM_OPS && strcmp(tok, loadgen::OP_NAMES[k]))
+        {
+            ++k;
+        }
+        if (k >= loadgen::NUM_OPS)
+        {
+            fprintf(stderr, "Unknown request kind %s\n", tok);
+            usage("load_test");
+        }
+        cfg.weight[k] = atoi(eq + 1);
+    }
+}
+
+/// Reads the frames to replay.
+/// @param path is the log file.
+void read_replay(const char *path)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror(path);
+        exit(1);
+    }
+    std::string text;
+    char buf[4096];
+    ssize_t len;
+    while ((len = ::read(fd, buf, sizeof(buf))) > 0)
+    {
+        text.append(buf, len);
+    }
+    ::close(fd);
+    if (!loadgen::parse_replay(text, &cfg.replay))
+    {
+        fprintf(stderr, "No frames found in %s\n", path);
+        exit(1);
+    }
+}
+
+void parse_args(int argc, char *argv[])
+{
+    int opt;
+    bool have_mix = false;
+    const char *replay_path = nullptr;
+    while ((opt = getopt(argc, argv, "hi:p:d:n:T:e:E:t:c:m:r:s:l:o:")) >= 0)
+    {
+        switch (opt)
+        {
+            case 'h':
+                usage(argv[0]);
+                break;
+            case 'i':
+                host = optarg;
+                break;
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'd':
+                device_path = optarg;
+                break;
+            case 'n':
+                cfg.target = strtoull(optarg, nullptr, 16);
+                break;
+            case 'T':
+                cfg.train = strtoull(optarg, nullptr, 16);
+                break;
+            case 'e':
+                cfg.event_base = strtoull(optarg, nullptr, 16);
+                break;
+            case 'E':
+                cfg.num_events = atoi(optarg);
+                break;
+            case 't':
+                cfg.duration_nsec = (long long)(atof(optarg) * 1e9);
+                break;
+            case 'c':
+                cfg.slots = atoi(optarg);
+                break;
+            case 'm':
+                parse_mix(optarg);
+                have_mix = true;
+                break;
+            case 'r':
+                replay_path = optarg;
+                break;
+            case 's':
+                cfg.seed = atoi(optarg);
+                break;
+            case 'l':
+                export_port = atoi(optarg);
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            default:
+                fprintf(stderr, "Unknown option %c\n", opt);
+                usage(argv[0]);
+        }
+    }
+    if (cfg.slots < 1 || cfg.slots > 255)
+    {
+        fprintf(stderr, "Number of slots must be 1..255\n");
+        usage(argv[0]);
+    }
+    if ((host || device_path) && !cfg.target)
+    {
+        fprintf(stderr, "Remote mode needs the node ID of the target (-n)\n");
+        usage(argv[0]);
+    }
+    if (replay_path)
+    {
+        read_replay(replay_path);
+        if (!have_mix)
+        {
+            cfg.weight[loadgen::OP_REPLAY] = 1;
+        }
+    }
+}
+
+/// Train implementation for the local node under test. Does nothing, so that
+/// only the stack is measured.
+class BenchTrain : public openlcb::TrainImpl
+{
+public:
+    void set_speed(openlcb::SpeedType speed) override
+    {
+        speed_ = speed;
+    }
+
+    openlcb::SpeedType get_speed() override
+    {
+        return speed_;
+    }
+
+    void set_emergencystop() override
+    {
+        speed_.set_mph(0);
+    }
+
+    void set_fn(uint32_t address, uint16_t value) override
+    {
+    }
+
+    uint16_t get_fn(uint32_t address) override
+    {
+        return 0;
+    }
+
+    uint32_t legacy_address() override
+    {
+        return 3;
+    }
+
+    dcc::TrainAddressType legacy_address_type() override
+    {
+        return dcc::TrainAddressType::DCC_SHORT_ADDRESS;
+    }
+
+private:
+    openlcb::SpeedType speed_;
+};
+
+/// Node under test running in this process.
+struct LocalTarget
+{
+    LocalTarget(unsigned num_events, uint64_t event_base)
+        : snipFile_("Load test", "Load test node")
+        , stack_(NODE_ID)
+        , tractionService_(stack_.iface())
+        , trainNode_(&tractionService_, &train_, TRAIN_NODE_ID)
+        , bits_((num_events + 31) / 32)
+        , events_(stack_.node(), event_base, bits_.data(), num_events)
+    {
+        if (export_port)
+        {
+            tcpHub_.reset(new GcTcpHub(stack_.can_hub(), export_port));
+        }
+        stack_.start_executor_thread("stack", 0, 2048);
+    }
+
+    openlcb::MockSNIPUserFile snipFile_;
+    openlcb::SimpleCanStack stack_;
+    openlcb::TrainService tractionService_;
+    BenchTrain train_;
+    openlcb::TrainNodeWithId trainNode_;
+    std::vector<uint32_t> bits_;
+    openlcb::BitRangeEventPC events_;
+    std::unique_ptr<GcTcpHub> tcpHub_;
+};
+
+/** Entry point to application.
+ * @param argc number of command line arguments
+ * @param argv array of command line arguments
+ * @return 0 if the test ran, 1 on error.
+ */
+int appl_main(int argc, char *argv[])
+{
+    parse_args(argc, argv);
+
+    std::unique_ptr<LocalTarget> local;
+    std::unique_ptr<Executor<1>> executor;
+    std::unique_ptr<Service> service;
+    std::unique_ptr<CanHubFlow> remote_hub;
+    CanHubFlow *hub;
+    if (host || device_path)
+    {
+        executor.reset(new Executor<1>("executor", 0, 2048));
+        service.reset(new Service(executor.get()));
+        remote_hub.reset(new CanHubFlow(service.get()));
+        int fd = device_path ? ::open(device_path, O_RDWR)
+                             : ConnectSocket(host, port);
+        if (fd < 0)
+        {
+            fprintf(stderr, "Failed to connect to %s\n",
+                device_path ? device_path : host);
+            return 1;
+        }
+        create_gc_port_for_can_hub(remote_hub.get(), fd);
+        hub = remote_hub.get();
+    }
+    else
+    {
+        if (!cfg.num_events)
+        {
+            cfg.num_events = 256;
+        }
+        if (!cfg.event_base)
+        {
+            cfg.event_base = 0x0501010119900000ULL;
+        }
+        cfg.target = NODE_ID;
+        cfg.train = TRAIN_NODE_ID;
+        local.reset(new LocalTarget(cfg.num_events, cfg.event_base));
+        hub = local->stack_.can_hub();
+        // Lets the nodes come up.
+        usleep(500000);
+    }
+
+    SyncNotifiable n;
+    loadgen::LoadGenerator gen(hub, cfg);
+    gen.run(&n);
+    n.wait_for_notification();
+
+    if (gen.failed())
+    {
+        fprintf(stderr, "%s\n", gen.error().c_str());
+    }
+    fprintf(stderr, "%s", gen.text_results().c_str());
+    if (output_path)
+    {
+        std::string json = gen.json_results();
+        FILE *f = strcmp(output_path, "-") ? fopen(output_path, "w") : stdout;
+        if (!f)
+        {
+            perror(output_path);
+            return 1;
+        }
+        fputs(json.c_str(), f);
+        if (f == stdout)
+        {
+            fflush(f);
+        }
+        else
+        {
+            fclose(f);
+        }
+    }
+    // The executors are still running; exits without tearing down the stack.
+    _exit(gen.failed() ? 1 : 0);
+}
@@ -38,7 +38,7 @@ namespace openlcb
 /// - the generated cdi.xml will include this data
 /// - the Simple Node Ident Info Protocol will return this data
 /// - the ACDI memory space will contain this data.
-extern const SimpleNodeStaticValues SNIP_STATIC_DATA = {
+extern constexpr SimpleNodeStaticValues SNIP_STATIC_DATA = {
     4, "Balazs Racz", "Dead-rail train", "ESP12", "0.1"};
 
 static const uint16_t EXPECTED_VERSION = 0x1bd6;
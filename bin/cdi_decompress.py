@@ -0,0 +1,134 @@
+#!/usr/bin/env python
+# Copyright (c) 2026, agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are  permitted provided that the following conditions are met:
+# 
+#  - Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+#  - Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# Decompresses a cdi.xml read from the compressed CDI memory space (0xF7) of
+# an OpenMRN node. See src/utils/LzCompressor.hxx for the format.
+#
+# Usage: cdi_decompress.py [-i compressed.bin] [-o cdi.xml]
+#
+# @author agent
+# @date 19 Oct 2026
+
+import sys
+from optparse import OptionParser
+
+FORMAT_VERSION = 1
+MIN_MATCH = 3
+EXT_MATCH = MIN_MATCH + 15
+
+# Preset dictionary. Must be identical to LzDefs::DICTIONARY in
+# src/utils/LzCompressor.cxx.
+DICTIONARY = (
+    b"<?xml version=\"1.0\"?>\n<cdi "
+    b"xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+    b"xsi:noNamespaceSchemaLocation=\"http://openlcb.org/schema/cdi/1/1/"
+    b"cdi.xsd\">\n<identification>\n<manufacturer></manufacturer>\n<model>"
+    b"</model>\n<hardwareVersion></hardwareVersion>\n<softwareVersion>"
+    b"</softwareVersion>\n</identification>\n<acdi/>\n<segment space='251' "
+    b"origin='1'>\n<string size='63'>\n<name>User name</name>\n<description>"
+    b"This name will appear in network browsers for the current node."
+    b"</description>\n</string>\n<string size='64'>\n<name>User description"
+    b"</name>\n<description>This description will appear in network browsers "
+    b"for the current node.</description>\n</string>\n</segment>\n<segment "
+    b"space='253' origin='128'>\n<group>\n<name>Internal data</name>\n"
+    b"<description>Do not change these settings.</description>\n<int size='2'>"
+    b"\n<name>Version</name>\n</int>\n<int size='2'>\n<name>Next event ID"
+    b"</name>\n</int>\n</group>\n<group replication=''>\n<name>Description"
+    b"</name>\n<description>User name of this </description>\n<repname>"
+    b"</repname>\n<group offset=''/>\n<map>\n<relation>\n<property>"
+    b"</property>\n<value></value>\n</relation>\n</map>\n<min></min>\n<max>"
+    b"</max>\n<default></default>\n<int size='1'>\n<eventid>\n<name>Event "
+    b"On</name>\n</eventid>\n<eventid>\n<name>Event Off</name>\n</eventid>\n"
+    b"</int>\n</group>\n</segment>\n</cdi>\n")
+
+
+def decompress(data):
+    """Decompresses a byte string. Raises ValueError if it is malformed."""
+    data = bytearray(data)
+    if len(data) < 5 or data[0] != FORMAT_VERSION:
+        raise ValueError("bad header")
+    size = (data[1] << 24) | (data[2] << 16) | (data[3] << 8) | data[4]
+    hist = bytearray(DICTIONARY)
+    start = len(hist)
+    i = 5
+    while i < len(data):
+        c = data[i]
+        if c < 0x80:
+            hist.append(c)
+            i += 1
+            continue
+        if i + 1 >= len(data):
+            raise ValueError("truncated token")
+        l = (c >> 3) & 15
+        dist = ((c & 7) << 8) | data[i + 1]
+        i += 2
+        if dist == 0:
+            if l != 0 or i >= len(data):
+                raise ValueError("bad escape")
+            hist.append(data[i])
+            i += 1
+            continue
+        count = l + MIN_MATCH
+        if l == 15:
+            if i >= len(data):
+                raise ValueError("truncated token")
+            count = EXT_MATCH + data[i]
+            i += 1
+        if dist > len(hist):
+            raise ValueError("reference out of range")
+        frm = len(hist) - dist
+        for k in range(count):
+            hist.append(hist[frm + k])
+    out = bytes(hist[start:])
+    if len(out) != size:
+        raise ValueError("length mismatch: %d instead of %d" % (len(out), size))
+    return out
+
+
+def main():
+    parser = OptionParser()
+    parser.add_option("-i", "--input", dest="input",
+                      help="compressed input file (default: stdin)")
+    parser.add_option("-o", "--output", dest="output",
+                      help="output cdi.xml file (default: stdout)")
+    (options, args) = parser.parse_args()
+    if options.input:
+        with open(options.input, "rb") as f:
+            data = f.read()
+    else:
+        data = getattr(sys.stdin, "buffer", sys.stdin).read()
+    out = decompress(data)
+    # The memory space contains the terminating zero of the CDI string.
+    out = out.rstrip(b"\0")
+    if options.output:
+        with open(options.output, "wb") as f:
+            f.write(out)
+    else:
+        getattr(sys.stdout, "buffer", sys.stdout).write(out)
+
+
+if __name__ == "__main__":
+    main()
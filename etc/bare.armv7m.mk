@@ -44,7 +44,7 @@ CFLAGS = -c  $(ARCHOPTIMIZATION) $(CORECFLAGS) -std=gnu99 \
           -Wstrict-prototypes \
           $(CFLAGSENV) $(CFLAGSEXTRA)
 
-CXXFLAGS = -c $(ARCHOPTIMIZATION) $(CORECFLAGS) -std=gnu++0x  \
+CXXFLAGS = -c $(ARCHOPTIMIZATION) $(CORECFLAGS) -std=gnu++14  \
            -D_ISOC99_SOURCE -D__USE_LIBSTDCPP__ -D__STDC_FORMAT_MACROS \
            -fno-exceptions -fno-rtti \
             $(CXXFLAGSENV) $(CXXFLAGSEXTRA) \
@@ -42,6 +42,15 @@ $(TESTBINS): %.test$(EXTENTION) : %.test.o $(TESTOBJSEXTRA) $(LIBDIR)/timestamp
 $(TESTOBJS): %.test.o : $(SRCDIR)/%.cxxtest
 	$(CXX) $(CXXFLAGS) -MD -MF $*.dtest -x c++ $< -o $@
 
+# CoroutineFlow and the flows ported to it (CoroutinePIPClient) need C++20.
+# The firmware toolchains and the libraries stay on the older standard, so only
+# the tests exercising the coroutines are compiled with it. The coroutine
+# classes are only defined under __cpp_impl_coroutine; the classes these tests
+# share with the libraries are the same in both standards. The later -std flag
+# wins over the one in CXXFLAGS.
+COROUTINE_TESTOBJS = executor/CoroutineFlow.test.o openlcb/PIPClient.test.o
+$(filter $(COROUTINE_TESTOBJS),$(TESTOBJS)): CXXFLAGS += -std=c++20
+
 gtest-all.o : %.o : $(GTESTSRCPATH)/src/%.cc
 	$(CXX) $(CXXFLAGS) -I$(GTESTPATH) -I$(GTESTSRCPATH) -MD -MF $*.d   $< -o $@
 
@@ -68,7 +68,7 @@ EXCEPT_FLAG := # -fno-rtti # -fno-exceptions
 
 # -MT"$(@:%.o=%.d)"
 CXXFLAGS = $(ARCHOPTIMIZATION) $(CORECFLAGS) $(EXCEPT_FLAG) \
-            -std=gnu++0x \
+            -std=gnu++14 \
            -mthumb  \
             -D__STDC_FORMAT_MACROS \
            $(CXXFLAGSENV)
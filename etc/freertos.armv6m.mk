@@ -54,7 +54,7 @@ CORECFLAGS = $(ARCHOPTIMIZATION) $(ARCHFLAGS) -Wall -Werror \
 CFLAGS += -c $(CORECFLAGS) -std=gnu99 -Wstrict-prototypes  \
           $(CFLAGSENV) $(CFLAGSEXTRA)
 
-CXXFLAGS += -c $(CORECFLAGS) -std=gnu++0x -D_ISOC99_SOURCE \
+CXXFLAGS += -c $(CORECFLAGS) -std=gnu++14 -D_ISOC99_SOURCE \
             -D__USE_LIBSTDCPP__ -D__STDC_FORMAT_MACROS -D__LINEAR_MAP__ \
             -fno-exceptions -fno-rtti $(CXXFLAGSENV) $(CXXFLAGSEXTRA)
 
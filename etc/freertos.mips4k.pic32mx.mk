@@ -69,7 +69,7 @@ CORECFLAGS = -c -EL -g -msoft-float -march=mips32r2 $(ARCHOPTIMIZATION) \
 
 CFLAGS =  $(CORECFLAGS) -std=gnu99 -Wstrict-prototypes  $(CFLAGSENV)
 
-CXXFLAGS = $(CORECFLAGS)  -std=c++0x  -D_ISOC99_SOURCE -fno-exceptions  \
+CXXFLAGS = $(CORECFLAGS)  -std=c++14  -D_ISOC99_SOURCE -fno-exceptions  \
            -fno-rtti -D__STDC_FORMAT_MACROS $(CXXFLAGSENV) -U__STRICT_ANSI__ # -D__STDC_VERSION__=199902L
 
 LDFLAGS = -EL $(ARCH) -g -T target.ld -fdata-sections -ffunction-sections  -Xlinker \
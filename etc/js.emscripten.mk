@@ -30,7 +30,7 @@ CSHAREDFLAGS = -c $(ARCHOPTIMIZATION) -Wall -Werror -MP -m32 -fno-stack-protecto
 
 CFLAGS = $(CSHAREDFLAGS) -std=gnu99
 
-CXXFLAGS = $(CSHAREDFLAGS) -std=c++0x -D__STDC_FORMAT_MACROS \
+CXXFLAGS = $(CSHAREDFLAGS) -std=c++14 -D__STDC_FORMAT_MACROS \
            -D__STDC_LIMIT_MACROS #-D__LINEAR_MAP__
 
 LDFLAGS = -g -m32 -Wl,-Map="$(@:%=%.map)" --em-config $(EMSDKPATH)/../../.emscripten -s ASSERTIONS=2
@@ -34,7 +34,7 @@ CSHAREDFLAGS = -c $(ARCHOPTIMIZATION) -Wall -Werror -Wno-unknown-pragmas \
 
 CFLAGS = $(CSHAREDFLAGS) -std=gnu99
 
-CXXFLAGS = $(CSHAREDFLAGS) -std=c++0x -D__STDC_FORMAT_MACROS \
+CXXFLAGS = $(CSHAREDFLAGS) -std=c++14 -D__STDC_FORMAT_MACROS \
            -D__STDC_LIMIT_MACROS -D__USE_LIBSTDCPP__
 
 LDFLAGS = $(ARCHOPTIMIZATION) -Wl,-Map="$(@:%=%.map)"
@@ -31,7 +31,7 @@ CSHAREDFLAGS = -c $(ARCHOPTIMIZATION) -Wall -Werror -MP -fno-stack-protector -D_
 
 CFLAGS = $(CSHAREDFLAGS) -std=gnu99
 
-CXXFLAGS = $(CSHAREDFLAGS) -std=c++0x -D__STDC_FORMAT_MACROS \
+CXXFLAGS = $(CSHAREDFLAGS) -std=c++14 -D__STDC_FORMAT_MACROS \
            -D__STDC_LIMIT_MACROS #-D__LINEAR_MAP__
 
 LDFLAGS = -g $(ARCHSELECT) -Wl,-Map="$(@:%=%.map)"
@@ -20,7 +20,7 @@ INCLUDES += -I$(OPENMRNPATH)/include/mach
 
 CFLAGS = -c -g -O0 -Wall -Werror -MD -MP -std=gnu99 -m32 -fno-stack-protector \
          -D_GNU_SOURCE
-CXXFLAGS = -c -g -O0 -Wall -Werror -MD -MP -std=c++0x -m32 -fno-stack-protector \
+CXXFLAGS = -c -g -O0 -Wall -Werror -MD -MP -std=c++14 -m32 -fno-stack-protector \
            -D_GNU_SOURCE -D__STDC_FORMAT_MACROS
 
 LDFLAGS = -g -m32
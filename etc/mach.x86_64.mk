@@ -22,7 +22,7 @@ INCLUDES += -I$(OPENMRNPATH)/include/mach
 
 CFLAGS = -c -g -O0 -Wall -Werror -MD -MP -std=gnu99 -fno-stack-protector \
          -D_GNU_SOURCE
-CXXFLAGS = -c -g -O0 -Wall -Werror -MD -MP -std=c++0x -fno-stack-protector \
+CXXFLAGS = -c -g -O0 -Wall -Werror -MD -MP -std=c++14 -fno-stack-protector \
            -D_GNU_SOURCE
 
 LDFLAGS = -g
@@ -133,10 +133,34 @@ DECLARE_CONST(num_memory_spaces);
  * from the SimpleStack. */
 DECLARE_CONST(enable_all_memory_space);
 
+/** Set to CONSTANT_TRUE if you want the SimpleStack to export the CDI in
+ * compressed form in an additional memory space (0xF7). */
+DECLARE_CONST(enable_compressed_cdi_space);
+
+/** Largest number of bytes of the config file the ConfigUpdateFlow reads into
+ * RAM at once while calling the config update listeners. */
+DECLARE_CONST(config_update_cache_size);
+
 /** Set to CONSTANT_TRUE if you want the nodes to send out producer / consumer
  * identified messages at boot time. This is required by the OpenLCB
  * standard. */
 DECLARE_CONST(node_init_identify);
 
+/** Average CAN frame rate that the initialization of virtual nodes may use.
+ * Nodes are started slower when many are initialized at once. 0 means no
+ * limit. */
+DECLARE_CONST(node_init_frames_per_sec);
+
+/** Estimated number of frames the initialization of a virtual node sends, for
+ * the node_init_frames_per_sec rate limit. */
+DECLARE_CONST(node_init_frames_per_node);
+
+/** How many frames the node initialization may send at once after the bus was
+ * idle, when node_init_frames_per_sec is set. */
+DECLARE_CONST(node_init_frame_burst);
+
+/** Stack size in bytes of the executor threads of a sharded TrainService. */
+DECLARE_CONST(traction_shard_stack_size);
+
 
 #endif /* _nmranet_config_h_ */
@@ -0,0 +1,63 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file ExecutorProfilerCommand.cxx
+ *
+ * Console command printing the report of an ExecutorProfiler.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include "console/ExecutorProfilerCommand.hxx"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "executor/ExecutorProfiler.hxx"
+
+Console::CommandStatus executor_profiler_command(
+    FILE *fp, int argc, const char *argv[], void *context)
+{
+    ExecutorProfiler *p = static_cast<ExecutorProfiler *>(context);
+    if (argc > 2)
+    {
+        fprintf(fp, "usage: %s [clear | top_n]\n", argv[0]);
+        return Console::COMMAND_ERROR;
+    }
+    if (argc == 2 && !strcmp(argv[1], "clear"))
+    {
+        p->clear();
+        return Console::COMMAND_OK;
+    }
+    unsigned top_n = 10;
+    if (argc == 2)
+    {
+        top_n = atoi(argv[1]);
+    }
+    p->print_report(fp, top_n);
+    return Console::COMMAND_OK;
+}
@@ -0,0 +1,55 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file ExecutorProfilerCommand.hxx
+ *
+ * Console command printing the report of an ExecutorProfiler.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _CONSOLE_EXECUTORPROFILERCOMMAND_HXX_
+#define _CONSOLE_EXECUTORPROFILERCOMMAND_HXX_
+
+#include "console/Console.hxx"
+
+class ExecutorProfiler;
+
+/// Console command to print the report of an ExecutorProfiler. Arguments:
+/// none, a number for top-N, or "clear".
+///
+/// Usage:
+///
+///   console.add_command("prof", executor_profiler_command, &prof);
+///
+/// @param fp console output. @param argc number of args. @param argv
+/// args. @param context the ExecutorProfiler.
+/// @return command status.
+Console::CommandStatus executor_profiler_command(
+    FILE *fp, int argc, const char *argv[], void *context);
+
+#endif // _CONSOLE_EXECUTORPROFILERCOMMAND_HXX_
@@ -95,11 +95,7 @@ void DccTrain<Payload>::get_next_packet(unsigned code, Packet *packet)
     }
     if (code == REFRESH)
     {
-        code = MIN_REFRESH + this->p.nextRefresh_++;
-        if (this->p.nextRefresh_ > MAX_REFRESH - MIN_REFRESH)
-        {
-            this->p.nextRefresh_ = 0;
-        }
+        code = this->next_refresh_code();
     }
     else
     {
@@ -156,6 +152,50 @@ void DccTrain<Payload>::get_next_packet(unsigned code, Packet *packet)
     }
 }
 
+template <class Payload>
+constexpr unsigned CachedDccTrain<Payload>::NUM_CACHED;
+
+// Generates next outgoing packet, using the cache when possible.
+template <class Payload>
+void CachedDccTrain<Payload>::get_next_packet(unsigned code, Packet *packet)
+{
+    bool is_refresh = false;
+    if (code == REFRESH)
+    {
+        code = this->next_refresh_code();
+        is_refresh = true;
+    }
+    if (code < SPEED || code >= SPEED + NUM_CACHED)
+    {
+        // ESTOP and unknown codes are not cached.
+        DccTrain<Payload>::get_next_packet(code, packet);
+        return;
+    }
+    unsigned idx = code - SPEED;
+    CacheEntry &e = cache_[idx];
+    if (validMask_ & (1u << idx))
+    {
+        packet->start_dcc_packet();
+        packet->packet_header.skip_ec = 1;
+        packet->dlc = e.dlc;
+        memcpy(packet->payload, e.payload, e.dlc);
+        if (code == SPEED)
+        {
+            this->p.directionChanged_ = 0;
+        }
+    }
+    else
+    {
+        DccTrain<Payload>::get_next_packet(code, packet);
+        HASSERT(packet->dlc <= sizeof(e.payload));
+        e.dlc = packet->dlc;
+        memcpy(e.payload, packet->payload, packet->dlc);
+        validMask_ |= (1u << idx);
+    }
+    // Matches the repeat count of DccTrain::get_next_packet.
+    packet->packet_header.rept_count = is_refresh ? 0 : 1;
+}
+
 MMOldTrain::MMOldTrain(MMAddress a)
 {
     p.address_ = a.value;
@@ -271,6 +311,8 @@ void createtrains() {
     Dcc128Train train2(DccShortAddress(1));
     MMNewTrain train3(MMAddress(1));
     MMOldTrain train4(MMAddress(1));
+    CachedDcc28Train train5(DccShortAddress(1));
+    CachedDcc128Train train6(DccShortAddress(1));
 }
 
 } // namespace dcc
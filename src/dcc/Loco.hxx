@@ -131,7 +131,7 @@ public:
         {
             p.speed_ = 0;
         }
-        packet_processor_notify_update(this, SPEED);
+        update(SPEED);
     }
 
     /// @return the last set speed.
@@ -155,7 +155,7 @@ public:
         dir0.set_direction(p.direction_);
         p.lastSetSpeed_ = dir0.get_wire();
         p.directionChanged_ = 1;
-        packet_processor_notify_update(this, ESTOP);
+        update(ESTOP);
     }
     /// Sets a function to a given value. @param address is the function number
     /// (0..28), @param value is 0 for funciton OFF, 1 for function ON.
@@ -175,7 +175,7 @@ public:
         {
             p.fn_ &= ~bit;
         }
-        packet_processor_notify_update(this, p.get_fn_update_code(address));
+        update(p.get_fn_update_code(address));
     }
     /// @return the last set value of a given function, or 0 if the function is
     /// not known. @param address is the function address.
@@ -200,8 +200,23 @@ public:
     }
 
 protected:
+    /// Called after the train state was changed, before the update loop is
+    /// notified. @param code is the update code describing what changed.
+    virtual void state_changed(unsigned code)
+    {
+    }
+
     /// Payload -- actual data we know about the train.
     P p;
+
+private:
+    /// Notifies the update loop that the train state has changed. @param code
+    /// is the update code describing what changed.
+    void update(unsigned code)
+    {
+        state_changed(code);
+        packet_processor_notify_update(this, code);
+    }
 };
 
 /// Structure defining the volatile state for a 28-speed-step DCC locomotive.
@@ -291,11 +306,79 @@ public:
     /// requested by the previous cycle or the on-update notification). @param
     /// packet needs to be filled in for the output.
     void get_next_packet(unsigned code, Packet *packet) OVERRIDE;
+
+protected:
+    /// Advances the background refresh cycle. @return the packet code to
+    /// generate for the current refresh packet.
+    unsigned next_refresh_code()
+    {
+        unsigned code = MIN_REFRESH + this->p.nextRefresh_++;
+        if (this->p.nextRefresh_ > MAX_REFRESH - MIN_REFRESH)
+        {
+            this->p.nextRefresh_ = 0;
+        }
+        return code;
+    }
 };
 
 /// TrainImpl class for a 28-speed-step DCC locomotive.
 typedef DccTrain<Dcc28Payload> Dcc28Train;
 
+/// TrainImpl class for a DCC locomotive that keeps the encoded speed and
+/// function packets in RAM. Refresh packets are copied from the cache instead
+/// of being encoded and checksummed every time; a cache entry is rebuilt only
+/// after the respective state changes. This costs about 40 bytes of RAM per
+/// train, so it is meant for command stations on larger hosts refreshing
+/// many trains.
+template <class Payload> class CachedDccTrain : public DccTrain<Payload>
+{
+public:
+    /// Constructor. @param a is the address (DccShortAddress or
+    /// DccLongAddress).
+    template <class A>
+    CachedDccTrain(A a)
+        : DccTrain<Payload>(a)
+    {
+    }
+
+    /// Generates next outgoing packet. @param code is the packet code (as
+    /// requested by the previous cycle or the on-update notification). @param
+    /// packet needs to be filled in for the output.
+    void get_next_packet(unsigned code, Packet *packet) OVERRIDE;
+
+private:
+    /// Number of cached packet codes (SPEED..FUNCTION21).
+    static constexpr unsigned NUM_CACHED = FUNCTION21 - SPEED + 1;
+
+    /// Marks the cached packet for a given code as stale. @param code is the
+    /// update code (SPEED, ESTOP or one of the FUNCTIONx codes).
+    void state_changed(unsigned code) OVERRIDE
+    {
+        if (code == ESTOP)
+        {
+            code = SPEED;
+        }
+        validMask_ &= ~(1u << (code - SPEED));
+    }
+
+    /// Encoded packet for one code, including address and checksum.
+    struct CacheEntry
+    {
+        /// Number of valid bytes in payload.
+        uint8_t dlc;
+        /// Packet bytes.
+        uint8_t payload[Packet::MAX_PAYLOAD - 1];
+    };
+
+    /// Cached packets, indexed by code - SPEED.
+    CacheEntry cache_[NUM_CACHED];
+    /// Bit (code - SPEED) is set if cache_[code - SPEED] is up-to-date.
+    uint8_t validMask_{0};
+};
+
+/// TrainImpl class for a 28-speed-step DCC locomotive with a packet cache.
+typedef CachedDccTrain<Dcc28Payload> CachedDcc28Train;
+
 /// Structure defining the volatile state for a 128-speed-step DCC locomotive.
 struct Dcc128Payload
 {
@@ -362,6 +445,8 @@ struct Dcc128Payload
 
 /// TrainImpl class for a 128-speed-step DCC locomotive.
 typedef DccTrain<Dcc128Payload> Dcc128Train;
+/// TrainImpl class for a 128-speed-step DCC locomotive with a packet cache.
+typedef CachedDccTrain<Dcc128Payload> CachedDcc128Train;
 
 /// Structure defining the volatile state for a Marklin-Motorola v1 protocol
 /// locomotive (with 14 speed steps, one function and relative direction only).
@@ -0,0 +1,169 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file PriorityUpdateLoop.cxx
+ *
+ * Control flow central to the command station: sends out freshly changed
+ * train state with priority, and refreshes the trains in the background
+ * oldest-first.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include "dcc/PriorityUpdateLoop.hxx"
+#include "dcc/Packet.hxx"
+#include "dcc/PacketSource.hxx"
+
+namespace dcc
+{
+
+constexpr unsigned PriorityUpdateLoop::MAX_URGENT_BURST;
+
+PriorityUpdateLoop::PriorityUpdateLoop(Service *service,
+    PacketFlowInterface *track_send, unsigned urgent_repeats,
+    long long min_refresh_nsec)
+    : StateFlow(service)
+    , trackSend_(track_send)
+    , urgentRepeats_(urgent_repeats ? urgent_repeats : 1)
+    , minRefreshNsec_(min_refresh_nsec)
+    , urgentBurst_(0)
+{
+}
+
+PriorityUpdateLoop::~PriorityUpdateLoop()
+{
+}
+
+void PriorityUpdateLoop::add_refresh_source(dcc::PacketSource *source)
+{
+    AtomicHolder h(this);
+    if (refreshIndex_.find(source) != refreshIndex_.end())
+    {
+        return;
+    }
+    // New trains go to the front: they have never been refreshed.
+    refreshList_.push_front({source, 0});
+    refreshIndex_[source] = refreshList_.begin();
+}
+
+void PriorityUpdateLoop::remove_refresh_source(dcc::PacketSource *source)
+{
+    AtomicHolder h(this);
+    auto it = refreshIndex_.find(source);
+    if (it != refreshIndex_.end())
+    {
+        refreshList_.erase(it->second);
+        refreshIndex_.erase(it);
+    }
+    for (auto uit = urgentQueue_.begin(); uit != urgentQueue_.end();)
+    {
+        if (uit->source == source)
+        {
+            uit = urgentQueue_.erase(uit);
+        }
+        else
+        {
+            ++uit;
+        }
+    }
+}
+
+void PriorityUpdateLoop::notify_update(PacketSource *source, unsigned code)
+{
+    AtomicHolder h(this);
+    for (auto &e : urgentQueue_)
+    {
+        if (e.source == source && e.code == code)
+        {
+            e.repeats = urgentRepeats_;
+            return;
+        }
+    }
+    urgentQueue_.push_back({source, static_cast<uint8_t>(code),
+        static_cast<uint8_t>(urgentRepeats_)});
+}
+
+void PriorityUpdateLoop::mark_sent(PacketSource *source, long long now)
+{
+    auto it = refreshIndex_.find(source);
+    if (it == refreshIndex_.end())
+    {
+        return;
+    }
+    it->second->lastSent = now;
+    refreshList_.splice(refreshList_.end(), refreshList_, it->second);
+}
+
+StateFlowBase::Action PriorityUpdateLoop::entry()
+{
+    long long current_time = os_get_time_monotonic();
+    PacketSource *source = nullptr;
+    unsigned code = 0;
+    {
+        AtomicHolder h(this);
+        bool refresh_due = !refreshList_.empty() &&
+            (current_time - refreshList_.front().lastSent >= minRefreshNsec_);
+        if (!urgentQueue_.empty() &&
+            (urgentBurst_ < MAX_URGENT_BURST || !refresh_due))
+        {
+            UrgentEntry e = urgentQueue_.front();
+            urgentQueue_.pop_front();
+            if (--e.repeats)
+            {
+                // Sends the same update again after the other pending ones.
+                urgentQueue_.push_back(e);
+            }
+            source = e.source;
+            code = e.code;
+            ++urgentBurst_;
+        }
+        else if (refresh_due)
+        {
+            source = refreshList_.front().source;
+            urgentBurst_ = 0;
+        }
+        if (source)
+        {
+            mark_sent(source, current_time);
+        }
+    }
+    if (source)
+    {
+        source->get_next_packet(code, message()->data());
+    }
+    else
+    {
+        // Nothing to send or the trains were all refreshed very recently. We
+        // send an idle packet instead.
+        message()->data()->set_dcc_idle();
+    }
+    // We pass on the filled packet to the track processor.
+    trackSend_->send(transfer_message());
+    return exit();
+}
+
+} // namespace dcc
@@ -0,0 +1,165 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file PriorityUpdateLoop.hxx
+ *
+ * Control flow central to the command station: sends out freshly changed
+ * train state with priority, and refreshes the trains in the background
+ * oldest-first.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _DCC_PRIORITYUPDATELOOP_HXX_
+#define _DCC_PRIORITYUPDATELOOP_HXX_
+
+#include <deque>
+#include <list>
+#include <map>
+
+#include "dcc/UpdateLoop.hxx"
+#include "executor/StateFlow.hxx"
+
+namespace dcc
+{
+
+/// Implementation of a command station update loop with prioritization.
+///
+/// Packets are generated from two sources:
+///
+/// - the urgent queue, which is fed by notify_update() whenever a train's
+///   state changes due to a user action. Every entry is sent out a
+///   configurable number of times (spread out by the other urgent entries)
+///   so that a decoder missing one packet will still quickly get the new
+///   state.
+///
+/// - the background refresh, which always picks the train that has not seen
+///   any packet for the longest time. Trains that recently got an urgent
+///   packet thus move to the back of the refresh order.
+///
+/// To avoid starving the background refresh when the urgent queue is
+/// continuously busy, at most MAX_URGENT_BURST urgent packets go out in a row
+/// before a background refresh packet is inserted.
+///
+/// Usage is identical to @ref SimpleUpdateLoop.
+class PriorityUpdateLoop : public StateFlow<Buffer<dcc::Packet>, QList<1>>,
+                           private UpdateLoopBase
+{
+public:
+    /// Constructor.
+    ///
+    /// @param service defines which executor to run on.
+    /// @param track_send where to send the filled packets.
+    /// @param urgent_repeats how many times a notified update should be sent
+    /// out from the urgent queue.
+    /// @param min_refresh_nsec minimum time between two packets to the same
+    /// train from the background refresh; if the oldest train is newer than
+    /// this, idle packets are generated.
+    PriorityUpdateLoop(Service *service, PacketFlowInterface *track_send,
+        unsigned urgent_repeats = 2,
+        long long min_refresh_nsec = MSEC_TO_NSEC(5));
+    ~PriorityUpdateLoop();
+
+    /// How many urgent packets may be sent in a row before a background
+    /// refresh packet is inserted.
+    static constexpr unsigned MAX_URGENT_BURST = 4;
+
+    /** Adds a new refresh source to the background refresh packets. */
+    void add_refresh_source(dcc::PacketSource *source) OVERRIDE;
+
+    /** Deletes a packet refresh source. */
+    void remove_refresh_source(dcc::PacketSource *source) OVERRIDE;
+
+    /** Enqueues an urgent update for a given source. If the same update is
+     * already pending, the repeat count is restarted instead of adding a
+     * second entry, because the train will anyway generate the packet from
+     * its freshest state. */
+    void notify_update(PacketSource *source, unsigned code) OVERRIDE;
+
+    /// @return the number of entries in the urgent queue.
+    size_t urgent_queue_size()
+    {
+        AtomicHolder h(this);
+        return urgentQueue_.size();
+    }
+
+    // Entry to the state flow -- when a new packet needs to be sent.
+    Action entry() OVERRIDE;
+
+private:
+    /// Background refresh state for one packet source.
+    struct RefreshEntry
+    {
+        /// Train to refresh.
+        PacketSource *source;
+        /// OS time of the last packet sent to this train.
+        long long lastSent;
+    };
+
+    /// Ordered by lastSent: the front is the train waiting the longest.
+    typedef std::list<RefreshEntry> RefreshList;
+
+    /// An entry in the urgent queue.
+    struct UrgentEntry
+    {
+        /// Train that needs to send the packet.
+        PacketSource *source;
+        /// Update code to pass to the train.
+        uint8_t code;
+        /// How many more times this entry needs to be sent.
+        uint8_t repeats;
+    };
+
+    /// Moves a train to the back of the refresh order. Must be called with
+    /// the lock held. @param source the train @param now current OS time.
+    void mark_sent(PacketSource *source, long long now);
+
+    /// Place where we forward the packets filled in.
+    PacketFlowInterface *trackSend_;
+
+    /// All trains in background refresh order.
+    RefreshList refreshList_;
+
+    /// Lookup from the train to its place in refreshList_.
+    std::map<PacketSource *, RefreshList::iterator> refreshIndex_;
+
+    /// Pending updates that came in through notify_update.
+    std::deque<UrgentEntry> urgentQueue_;
+
+    /// How many times to send every notified update.
+    unsigned urgentRepeats_;
+
+    /// Minimum time between background refresh packets to the same train.
+    long long minRefreshNsec_;
+
+    /// How many urgent packets were sent since the last background refresh.
+    unsigned urgentBurst_;
+};
+
+} // namespace dcc
+
+#endif // _DCC_PRIORITYUPDATELOOP_HXX_
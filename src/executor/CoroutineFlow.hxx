@@ -0,0 +1,621 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file CoroutineFlow.hxx
+ *
+ * Flows written as C++20 coroutines, running on the StateFlow machinery.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _EXECUTOR_COROUTINEFLOW_HXX_
+#define _EXECUTOR_COROUTINEFLOW_HXX_
+
+#include "executor/StateFlow.hxx"
+
+#if __cpp_impl_coroutine
+
+#include <coroutine>
+
+/// A flow written as one C++20 coroutine instead of a chain of state
+/// functions. It runs on the executor of a Service like any other StateFlow.
+/// Each co_await maps to one of the StateFlowBase actions (allocate_and_call,
+/// invoke_subflow_and_wait, sleep_and_call, read_repeated etc.), and the
+/// coroutine continues where the state flow would have called the next state.
+///
+/// When the result of an await is available right away (a pool with free
+/// memory, data already readable on the fd), the coroutine continues without
+/// going back through the executor. The state flow version pays an executor
+/// round trip for every allocation.
+///
+/// Usage:
+///
+/// class EchoFlow : public CoroutineFlow
+/// {
+/// public:
+///     EchoFlow(Service *s, int fd)
+///         : CoroutineFlow(s)
+///         , fd_(fd)
+///     {
+///         start();
+///     }
+///
+/// private:
+///     Task body() override
+///     {
+///         while (true)
+///         {
+///             int len = co_await read_single(fd_, buf_, sizeof(buf_));
+///             if (len < 0)
+///             {
+///                 co_return;
+///             }
+///             co_await write_repeated(fd_, buf_, len);
+///         }
+///     }
+///
+///     int fd_;
+///     char buf_[16];
+/// };
+///
+/// Local variables of body() live in a heap-allocated coroutine frame, which
+/// is allocated by start() and freed when body() returns or the flow is
+/// destroyed. The body must not delete the flow.
+///
+/// This header is only usable when compiling with coroutine support
+/// (-std=c++20); the rest of the tree does not depend on it.
+class CoroutineFlow : public StateFlowBase
+{
+public:
+    /// Return type of the coroutine body. Owns the coroutine frame.
+    class Task
+    {
+    public:
+        /// Coroutine promise type.
+        struct promise_type
+        {
+            /// @return the Task owning this coroutine.
+            Task get_return_object()
+            {
+                return Task(
+                    std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            /// The body only starts running when the flow gets scheduled on
+            /// the executor. @return awaitable.
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            /// The frame is kept until the flow destroys it. @return
+            /// awaitable.
+            std::suspend_always final_suspend() noexcept
+            {
+                return {};
+            }
+
+            void return_void()
+            {
+            }
+
+            void unhandled_exception()
+            {
+                DIE("Unhandled exception in a coroutine flow.");
+            }
+        };
+
+        Task()
+        {
+        }
+
+        /// Move constructor. @param o the task to take the frame from.
+        Task(Task &&o)
+            : handle_(o.handle_)
+        {
+            o.handle_ = nullptr;
+        }
+
+        /// Move assignment. @param o the task to take the frame from.
+        /// @return *this.
+        Task &operator=(Task &&o)
+        {
+            if (this != &o)
+            {
+                reset();
+                handle_ = o.handle_;
+                o.handle_ = nullptr;
+            }
+            return *this;
+        }
+
+        ~Task()
+        {
+            reset();
+        }
+
+    private:
+        friend class CoroutineFlow;
+
+        /// Constructor. @param h the coroutine frame to own.
+        explicit Task(std::coroutine_handle<promise_type> h)
+            : handle_(h)
+        {
+        }
+
+        /// Destroys the coroutine frame, if any.
+        void reset()
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+                handle_ = nullptr;
+            }
+        }
+
+        /// Coroutine frame, or nullptr.
+        std::coroutine_handle<promise_type> handle_;
+
+        DISALLOW_COPY_AND_ASSIGN(Task);
+    };
+
+    /// @return true if the body is not running (it has returned, or the flow
+    /// was never started).
+    bool is_done()
+    {
+        return is_terminated();
+    }
+
+protected:
+    /// Constructor. @param service defines which executor the flow runs on.
+    CoroutineFlow(Service *service)
+        : StateFlowBase(service)
+    {
+    }
+
+    /// The flow itself. Called by start().
+    /// @return the coroutine.
+    virtual Task body() = 0;
+
+    /// Starts running body() on the executor. Must not be called while the
+    /// body is running. May be called again after the body returned.
+    void start()
+    {
+        HASSERT(is_terminated());
+        task_ = body();
+        start_flow(STATE(resume_body));
+    }
+
+    /// Awaitable for a buffer allocation.
+    template <class T> class AllocateAwaiter
+    {
+    public:
+        /// Constructor. @param parent the flow. @param target_flow defines
+        /// the type of buffer. @param pool the pool to allocate from.
+        AllocateAwaiter(CoroutineFlow *parent,
+            FlowInterface<Buffer<T>> *target_flow, Pool *pool)
+            : parent_(parent)
+            , targetFlow_(target_flow)
+            , pool_(pool ? pool : target_flow->pool())
+        {
+        }
+
+        /// Tries to allocate synchronously. @return true if that worked.
+        bool await_ready()
+        {
+            pool_->alloc(&result_);
+            return result_ != nullptr;
+        }
+
+        /// Starts an asynchronous allocation.
+        void await_suspend(std::coroutine_handle<>)
+        {
+            parent_->pendingAction_ = parent_->allocate_and_call(
+                targetFlow_, resume_state(), pool_);
+        }
+
+        /// @return the allocated buffer.
+        Buffer<T> *await_resume()
+        {
+            if (!result_)
+            {
+                result_ = parent_->get_allocation_result(targetFlow_);
+            }
+            return result_;
+        }
+
+    private:
+        /// Flow that is waiting.
+        CoroutineFlow *parent_;
+        /// Defines the type of the buffer.
+        FlowInterface<Buffer<T>> *targetFlow_;
+        /// Pool to allocate from.
+        Pool *pool_;
+        /// Allocated buffer.
+        Buffer<T> *result_{nullptr};
+    };
+
+    /// Allocates a buffer. The coroutine continues without going through the
+    /// executor if the pool has free memory.
+    /// @param target_flow defines the type of buffer to allocate.
+    /// @param pool pool to allocate from; defaults to the pool of the target
+    /// flow.
+    /// @return awaitable yielding the allocated buffer.
+    template <class T>
+    AllocateAwaiter<T> allocate(
+        FlowInterface<Buffer<T>> *target_flow, Pool *pool = nullptr)
+    {
+        return AllocateAwaiter<T>(this, target_flow, pool);
+    }
+
+    /// Awaitable that suspends until the flow gets notified.
+    class NotifyAwaiter
+    {
+    public:
+        /// Constructor. @param parent the flow.
+        NotifyAwaiter(CoroutineFlow *parent)
+            : parent_(parent)
+        {
+        }
+
+        bool await_ready()
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<>)
+        {
+            parent_->pendingAction_ =
+                parent_->wait_and_call(resume_state());
+        }
+
+        void await_resume()
+        {
+        }
+
+    protected:
+        /// Flow that is waiting.
+        CoroutineFlow *parent_;
+    };
+
+    /// Suspends until the flow gets notified, for example by a
+    /// BarrierNotifiable reset to this flow. A notification that arrived
+    /// while the body was running also counts.
+    /// @return awaitable.
+    NotifyAwaiter wait_for_notification()
+    {
+        return NotifyAwaiter(this);
+    }
+
+    /// Awaitable for a subflow invocation.
+    template <class T> class SubflowAwaiter : public NotifyAwaiter
+    {
+    public:
+        /// Constructor. @param parent the flow. @param target_flow the
+        /// subflow.
+        SubflowAwaiter(
+            CoroutineFlow *parent, FlowInterface<Buffer<T>> *target_flow)
+            : NotifyAwaiter(parent)
+            , targetFlow_(target_flow)
+        {
+        }
+
+        /// @return the buffer sent to the subflow. The caller has to unref
+        /// it.
+        Buffer<T> *await_resume()
+        {
+            return this->parent_->full_allocation_result(targetFlow_);
+        }
+
+    private:
+        /// The subflow.
+        FlowInterface<Buffer<T>> *targetFlow_;
+    };
+
+    /// Calls a helper flow to perform some actions, and waits for its done
+    /// notifiable. Same as invoke_subflow_and_wait() in a state flow: T has
+    /// to have reset(args...) and a BarrierNotifiable done member.
+    /// @param target_flow is the helper flow.
+    /// @param args are forwarded to T::reset().
+    /// @return awaitable yielding the buffer that was sent to the helper
+    /// flow, with the results. The caller has to unref it.
+    template <class T, typename... Args>
+    SubflowAwaiter<T> invoke_subflow(
+        FlowInterface<Buffer<T>> *target_flow, Args &&... args)
+    {
+        invoke_subflow_and_wait(
+            target_flow, STATE(resume_body), std::forward<Args>(args)...);
+        return SubflowAwaiter<T>(this, target_flow);
+    }
+
+    /// Awaitable for a timer.
+    class SleepAwaiter
+    {
+    public:
+        /// Constructor. @param parent the flow. @param timer the timer to
+        /// start. @param timeout_nsec how long to sleep.
+        SleepAwaiter(CoroutineFlow *parent, ::Timer *timer, long long timeout_nsec)
+            : parent_(parent)
+            , timer_(timer)
+            , timeoutNsec_(timeout_nsec)
+        {
+        }
+
+        bool await_ready()
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<>)
+        {
+            parent_->pendingAction_ = parent_->sleep_and_call(
+                timer_, timeoutNsec_, resume_state());
+        }
+
+        /// @return true if the timer was triggered before it expired.
+        bool await_resume()
+        {
+            return timer_->is_triggered();
+        }
+
+    private:
+        /// Flow that is waiting.
+        CoroutineFlow *parent_;
+        /// Timer that will wake up the flow.
+        ::Timer *timer_;
+        /// How long to sleep.
+        long long timeoutNsec_;
+    };
+
+    /// Suspends the flow for a given time, using the timer of the flow. Call
+    /// timer().trigger() to wake it up early.
+    /// @param timeout_nsec how long to sleep.
+    /// @return awaitable yielding true if the timer was triggered early.
+    SleepAwaiter sleep(long long timeout_nsec)
+    {
+        return SleepAwaiter(this, &timer_, timeout_nsec);
+    }
+
+    /// Suspends the flow until a timer expires or gets triggered.
+    /// @param timer is the timer to start. It has to notify this flow, e.g.
+    /// a StateFlowTimer.
+    /// @param timeout_nsec how long to sleep.
+    /// @return awaitable yielding true if the timer was triggered early.
+    SleepAwaiter sleep(::Timer *timer, long long timeout_nsec)
+    {
+        return SleepAwaiter(this, timer, timeout_nsec);
+    }
+
+    /// @return the timer used by sleep(long long).
+    StateFlowTimer &timer()
+    {
+        return timer_;
+    }
+
+    /// Awaitable that puts the flow to the back of the executor queue.
+    class YieldAwaiter : public NotifyAwaiter
+    {
+    public:
+        /// Constructor. @param parent the flow.
+        YieldAwaiter(CoroutineFlow *parent)
+            : NotifyAwaiter(parent)
+        {
+        }
+
+        void await_suspend(std::coroutine_handle<>)
+        {
+            this->parent_->pendingAction_ = this->parent_->yield_and_call(
+                resume_state());
+        }
+    };
+
+    /// Lets the other executables on the executor run.
+    /// @return awaitable.
+    YieldAwaiter yield()
+    {
+        return YieldAwaiter(this);
+    }
+
+    /// Which fd operation an FdAwaiter performs.
+    enum FdOp
+    {
+        /// StateFlowBase::read_repeated
+        READ_REPEATED,
+        /// StateFlowBase::read_single
+        READ_SINGLE,
+        /// StateFlowBase::read_nonblocking
+        READ_NONBLOCKING,
+        /// StateFlowBase::write_repeated
+        WRITE_REPEATED
+    };
+
+    /// Awaitable for reading or writing an fd via select.
+    class FdAwaiter
+    {
+    public:
+        /// Constructor. @param parent the flow. @param op the operation.
+        /// @param fd the file descriptor. @param buf the data. @param size
+        /// number of bytes. @param priority executor priority to continue
+        /// with.
+        FdAwaiter(CoroutineFlow *parent, FdOp op, int fd, void *buf,
+            size_t size, unsigned priority)
+            : parent_(parent)
+            , op_(op)
+            , fd_(fd)
+            , buf_(buf)
+            , size_(size)
+            , priority_(priority)
+        {
+        }
+
+        bool await_ready()
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<>)
+        {
+            StateFlowSelectHelper *h = &parent_->selectHelper_;
+            h->hasError_ = 0;
+            Callback c = resume_state();
+            // All of these try the operation right away, and only go through
+            // select if the fd is not ready.
+            switch (op_)
+            {
+                case READ_REPEATED:
+                    parent_->pendingAction_ = parent_->StateFlowBase::read_repeated(
+                        h, fd_, buf_, size_, c, priority_);
+                    break;
+                case READ_SINGLE:
+                    parent_->pendingAction_ = parent_->StateFlowBase::read_single(
+                        h, fd_, buf_, size_, c, priority_);
+                    break;
+                case READ_NONBLOCKING:
+                    parent_->pendingAction_ =
+                        parent_->StateFlowBase::read_nonblocking(
+                            h, fd_, buf_, size_, c, priority_);
+                    break;
+                case WRITE_REPEATED:
+                    parent_->pendingAction_ =
+                        parent_->StateFlowBase::write_repeated(
+                            h, fd_, buf_, size_, c, priority_);
+                    break;
+            }
+        }
+
+        /// @return the number of bytes transferred, or -1 on error or EOF.
+        int await_resume()
+        {
+            StateFlowSelectHelper *h = &parent_->selectHelper_;
+            if (h->hasError_)
+            {
+                return -1;
+            }
+            return size_ - h->remaining_;
+        }
+
+    private:
+        /// Flow that is waiting.
+        CoroutineFlow *parent_;
+        /// What to do.
+        FdOp op_;
+        /// File descriptor.
+        int fd_;
+        /// Data to read into or write from.
+        void *buf_;
+        /// Number of bytes to transfer.
+        size_t size_;
+        /// Priority to continue with.
+        unsigned priority_;
+    };
+
+    /// Reads exactly size bytes from an fd, waiting with select as needed.
+    /// @param fd file descriptor (non-blocking). @param buf where to put the
+    /// data. @param size how many bytes to read. @param priority executor
+    /// priority to continue with.
+    /// @return awaitable yielding the number of bytes read, or -1 on error or
+    /// EOF.
+    FdAwaiter read_repeated(int fd, void *buf, size_t size,
+        unsigned priority = Selectable::MAX_PRIO)
+    {
+        return FdAwaiter(this, READ_REPEATED, fd, buf, size, priority);
+    }
+
+    /// Reads at most size bytes from an fd, waiting with select until at
+    /// least one byte is available.
+    /// @param fd file descriptor (non-blocking). @param buf where to put the
+    /// data. @param size how many bytes to read at most. @param priority
+    /// executor priority to continue with.
+    /// @return awaitable yielding the number of bytes read, or -1 on error or
+    /// EOF.
+    FdAwaiter read_single(int fd, void *buf, size_t size,
+        unsigned priority = Selectable::MAX_PRIO)
+    {
+        return FdAwaiter(this, READ_SINGLE, fd, buf, size, priority);
+    }
+
+    /// Reads at most size bytes from an fd, without waiting.
+    /// @param fd file descriptor (non-blocking). @param buf where to put the
+    /// data. @param size how many bytes to read at most. @param priority
+    /// executor priority to continue with.
+    /// @return awaitable yielding the number of bytes read (may be zero), or
+    /// -1 on error or EOF.
+    FdAwaiter read_nonblocking(int fd, void *buf, size_t size,
+        unsigned priority = Selectable::MAX_PRIO)
+    {
+        return FdAwaiter(this, READ_NONBLOCKING, fd, buf, size, priority);
+    }
+
+    /// Writes size bytes to an fd, waiting with select as needed.
+    /// @param fd file descriptor (non-blocking). @param buf the data; must
+    /// stay alive until the await completes. @param size how many bytes to
+    /// write. @param priority executor priority to continue with.
+    /// @return awaitable yielding the number of bytes written, or -1 on
+    /// error.
+    FdAwaiter write_repeated(int fd, const void *buf, size_t size,
+        unsigned priority = Selectable::MAX_PRIO)
+    {
+        return FdAwaiter(
+            this, WRITE_REPEATED, fd, const_cast<void *>(buf), size, priority);
+    }
+
+private:
+    /// @return resume_body as a state callback, for the awaitables.
+    static Callback resume_state()
+    {
+        return static_cast<Callback>(&CoroutineFlow::resume_body);
+    }
+
+    /// The only state of the flow: runs the coroutine until it suspends.
+    /// @return the action set up by the awaitable the coroutine suspended
+    /// on.
+    Action resume_body()
+    {
+        pendingAction_ = wait();
+        task_.handle_.resume();
+        if (task_.handle_.done())
+        {
+            task_.reset();
+            return exit();
+        }
+        return pendingAction_;
+    }
+
+    /// The coroutine of body().
+    Task task_;
+    /// What resume_body should return, set by the awaitable that suspended
+    /// the coroutine.
+    Action pendingAction_{nullptr};
+    /// Timer for sleep().
+    StateFlowTimer timer_{this};
+    /// Helper for the fd operations.
+    StateFlowSelectHelper selectHelper_{this};
+};
+
+#endif // __cpp_impl_coroutine
+
+#endif // _EXECUTOR_COROUTINEFLOW_HXX_
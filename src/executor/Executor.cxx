@@ -55,6 +55,7 @@ extern "C" {
 }
 #endif
 
+#include "executor/ExecutorProfiler.hxx"
 #include "executor/Service.hxx"
 #include "nmranet_config.h"
 
@@ -70,7 +71,8 @@ Executable::~Executable() {
 /** Constructor.
  */
 ExecutorBase::ExecutorBase()
-    : name_(NULL) /** @todo (Stuart Baker) is "name" still in use? */
+    : profiler_(nullptr)
+    , name_(NULL) /** @todo (Stuart Baker) is "name" still in use? */
     , next_(NULL)
     , activeTimers_(this)
     , done_(0)
@@ -172,6 +174,32 @@ void ExecutorBase::sync_run(std::function<void()> fn)
     }
 }
 
+void ExecutorBase::set_profiler(ExecutorProfiler *profiler)
+{
+    // Items already in the queue have no enqueue timestamp in the profiler,
+    // so they are not measured, no matter when they were added.
+    __atomic_store_n(&profiler_, profiler, __ATOMIC_RELEASE);
+}
+
+void ExecutorBase::record_enqueue(ExecutorProfiler *p, Executable *msg)
+{
+    p->record_enqueue(msg, os_get_time_monotonic());
+}
+
+void ExecutorBase::run_profiled(
+    ExecutorProfiler *p, Executable *msg, unsigned priority)
+{
+    long long start = os_get_time_monotonic();
+    p->record_dequeue(msg, priority, start);
+    ExecutorProfiler::Entry *entry = p->lookup(msg);
+    msg->run();
+    if (profiler_ == p)
+    {
+        // Otherwise the executable detached the profiler, and it may be gone.
+        p->record_run(entry, os_get_time_monotonic() - start);
+    }
+}
+
 bool ExecutorBase::loop_once()
 {
     unsigned priority;
@@ -187,9 +215,7 @@ bool ExecutorBase::loop_once()
         done_ = 1;
         return false;
     }
-    current_ = msg;
-    msg->run();
-    current_ = nullptr;
+    run_executable(msg, priority);
     return true;
 }
 
@@ -210,9 +236,7 @@ long long ICACHE_FLASH_ATTR  ExecutorBase::loop_some() {
         }
         if (msg != NULL)
         {
-            current_ = msg;
-            msg->run();
-            current_ = nullptr;
+            run_executable(msg, priority);
         }
     }
     // Still stuff pending to run.
@@ -314,9 +338,7 @@ void *ExecutorBase::entry()
         }
         if (msg != NULL)
         {
-            current_ = msg;
-            msg->run();
-            current_ = nullptr;
+            run_executable(msg, priority);
         }
     }
 
@@ -55,6 +55,7 @@ extern "C" {
 #endif
 
 class ActiveTimers;
+class ExecutorProfiler;
 
 /** This class implements an execution of tasks pulled off an input queue.
  */
@@ -149,9 +150,27 @@ public:
     /// executed. There could still be a current executable.
     virtual bool empty() = 0;
 
+    /// @return true if there are executables waiting to be executed at a
+    /// higher priority than the given one (i.e. a numerically smaller
+    /// priority band). @param priority the priority to compare to.
+    virtual bool has_higher_priority_work(unsigned priority) = 0;
+
     /// @return the thread handle.
     os_thread_t thread_handle() { return OSThread::get_handle(); }
 
+    /** Starts or stops collecting run time and queue wait statistics. Must be
+     * called on the executor thread (e.g. via sync_run), or before the
+     * executor is started.
+     * @param profiler collects the statistics. nullptr to stop profiling. */
+    void set_profiler(ExecutorProfiler *profiler);
+
+    /// @return the attached profiler, or nullptr if profiling is off. May be
+    /// called from any thread.
+    ExecutorProfiler *profiler()
+    {
+        return __atomic_load_n(&profiler_, __ATOMIC_ACQUIRE);
+    }
+
 protected:
     /** Thread entry point.
      * @return Should never return
@@ -160,9 +179,17 @@ protected:
 
     void run() override {}
 
+    /** Records the time an executable is added to the queue.
+     * @param p the attached profiler.
+     * @param msg the executable being added. */
+    static void record_enqueue(ExecutorProfiler *p, Executable *msg);
+
     /** Helper object for interruptible select calls. */
     OSSelectWakeup selectHelper_;
 
+    /** Collects statistics, or nullptr if profiling is off. */
+    ExecutorProfiler *profiler_;
+
 private:
 #ifndef ESP_NONOS
     /** Wait for an item from the front of the queue.
@@ -194,6 +221,31 @@ private:
      * @param next_timer_nsec is the maximum time to sleep in nanoseconds. */
     void wait_with_select(long long next_timer_nsec);
 
+    /** Runs an executable taken off the queue.
+     * @param msg the executable to run.
+     * @param priority priority band it was taken from. */
+    void run_executable(Executable *msg, unsigned priority)
+    {
+        current_ = msg;
+        // Only the executor thread changes profiler_.
+        ExecutorProfiler *p = profiler_;
+        if (p)
+        {
+            run_profiled(p, msg, priority);
+        }
+        else
+        {
+            msg->run();
+        }
+        current_ = nullptr;
+    }
+
+    /** Runs an executable with the profiler's accounting.
+     * @param p the attached profiler.
+     * @param msg the executable to run.
+     * @param priority priority band it was taken from. */
+    void run_profiled(ExecutorProfiler *p, Executable *msg, unsigned priority);
+
     /// Helper function.
     ///
     /// @param type a select type: READ, WRITE or EXCEPT
@@ -309,8 +361,16 @@ public:
      */
     void add(Executable *msg, unsigned priority = UINT_MAX) OVERRIDE
     {
-        queue_.insert(
-            msg, priority >= NUM_PRIO ? NUM_PRIO - 1 : priority);
+        if (priority >= NUM_PRIO)
+        {
+            priority = NUM_PRIO - 1;
+        }
+        ExecutorProfiler *p = profiler();
+        if (p)
+        {
+            record_enqueue(p, msg);
+        }
+        queue_.insert(msg, priority);
 #ifdef ESP_NONOS
         extern void wakeup_executor(ExecutorBase* executor);
         wakeup_executor(this);
@@ -327,8 +387,11 @@ public:
      */
     void add_from_isr(Executable *msg, unsigned priority = UINT_MAX) override
     {
-        queue_.insert_from_isr(
-            msg, priority >= NUM_PRIO ? NUM_PRIO - 1 : priority);
+        if (priority >= NUM_PRIO)
+        {
+            priority = NUM_PRIO - 1;
+        }
+        queue_.insert_from_isr(msg, priority);
         selectHelper_.wakeup_from_isr();
     }
 #endif
@@ -348,6 +411,22 @@ public:
         return queue_.empty();
     }
 
+    /// @return true if there are executables waiting to be executed at a
+    /// higher priority than the given one. @param priority the priority to
+    /// compare to.
+    bool has_higher_priority_work(unsigned priority) OVERRIDE
+    {
+        unsigned band = priority >= NUM_PRIO ? NUM_PRIO - 1 : priority;
+        for (unsigned i = 0; i < band; ++i)
+        {
+            if (!queue_.empty(i))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
 private:
 #ifndef ESP_NONOS
     /** Wait for an item from the front of the queue.
@@ -393,8 +472,15 @@ private:
 
     DISALLOW_COPY_AND_ASSIGN(Executor);
 
+#if LOCK_FREE_QUEUE_AVAILABLE && !defined(__FreeRTOS__)
+    /// Internal queue of executables waiting to be scheduled. Lock-free,
+    /// because add() is called from many threads (hub ports, timers, other
+    /// executors) on a host.
+    QListLockFreeWait<NUM_PRIO> queue_;
+#else
     /// Internal queue of executables waiting to be scheduled.
     QListProtectedWait<NUM_PRIO> queue_;
+#endif
 };
 
 /** This class can be given an executor, and will notify itself when that
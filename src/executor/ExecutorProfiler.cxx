@@ -0,0 +1,363 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file ExecutorProfiler.cxx
+ *
+ * Optional run-time and queue latency accounting for executors.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include "executor/ExecutorProfiler.hxx"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#ifdef __GXX_RTTI
+#include <typeinfo>
+#if !defined(__FreeRTOS__)
+#include <cxxabi.h>
+#define PROFILER_DEMANGLE
+#endif
+#endif
+
+#if !defined(__FreeRTOS__) && !defined(ESP_NONOS) && !defined(__WINNT__)
+#include <signal.h>
+#define PROFILER_SIGNAL
+#endif
+
+#include "executor/Executable.hxx"
+#include "os/os.h"
+
+#ifdef PROFILER_SIGNAL
+/// Incremented by the signal handler for each dump request.
+static volatile sig_atomic_t g_profiler_signal_count = 0;
+
+/// Signal handler for dump requests. @param signum ignored.
+static void profiler_signal_handler(int signum)
+{
+    g_profiler_signal_count = g_profiler_signal_count + 1;
+}
+
+void ExecutorProfiler::dump_on_signal(int signum)
+{
+    signal(signum, &profiler_signal_handler);
+}
+#endif
+
+constexpr unsigned ExecutorProfiler::NUM_BUCKETS;
+constexpr unsigned ExecutorProfiler::MAX_BANDS;
+constexpr unsigned ExecutorProfiler::WAIT_TABLE_SIZE;
+constexpr unsigned ExecutorProfiler::WAIT_PROBES;
+
+void ExecutorProfiler::Histogram::add(long long nsec)
+{
+    if (nsec < 0)
+    {
+        nsec = 0;
+    }
+    uint32_t usec = nsec >= 1000LL * UINT32_MAX ? UINT32_MAX : nsec / 1000;
+    unsigned bucket = usec ? 32 - __builtin_clz(usec) : 0;
+    if (bucket >= NUM_BUCKETS)
+    {
+        bucket = NUM_BUCKETS - 1;
+    }
+    ++buckets[bucket];
+    ++count;
+    totalNsec += nsec;
+    if (nsec > maxNsec)
+    {
+        maxNsec = nsec > UINT32_MAX ? UINT32_MAX : nsec;
+    }
+}
+
+uint32_t ExecutorProfiler::Histogram::percentile_usec(unsigned pct) const
+{
+    if (!count)
+    {
+        return 0;
+    }
+    // Rank of the sample we are looking for, rounded up.
+    uint64_t rank = ((uint64_t)count * pct + 99) / 100;
+    if (!rank)
+    {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < NUM_BUCKETS - 1; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            return 1u << i;
+        }
+    }
+    return (maxNsec + 999) / 1000;
+}
+
+ExecutorProfiler::ExecutorProfiler(unsigned max_entries)
+    : maxEntries_(max_entries)
+{
+    tableSize_ = 1;
+    while (tableSize_ < max_entries * 2)
+    {
+        tableSize_ <<= 1;
+    }
+    entries_ = new Entry[tableSize_];
+    memset(waitTable_, 0, sizeof(waitTable_));
+#ifdef PROFILER_SIGNAL
+    lastSignal_ = g_profiler_signal_count;
+#else
+    lastSignal_ = 0;
+#endif
+    clear();
+}
+
+ExecutorProfiler::~ExecutorProfiler()
+{
+    delete[] entries_;
+}
+
+void ExecutorProfiler::clear()
+{
+    AtomicHolder h(this);
+    memset(entries_, 0, sizeof(Entry) * tableSize_);
+    numEntries_ = 0;
+    memset(&other_, 0, sizeof(other_));
+    // The timestamp table belongs to the items in the queue.
+    memset(waits_, 0, sizeof(waits_));
+    __atomic_store_n(&lostWaitSamples_, 0, __ATOMIC_RELAXED);
+}
+
+void ExecutorProfiler::record_enqueue(Executable *e, long long now)
+{
+    unsigned first = wait_slot(e);
+    bool have_free = false;
+    for (unsigned i = 0; i < WAIT_PROBES; ++i)
+    {
+        WaitSlot *s = waitTable_ + ((first + i) & (WAIT_TABLE_SIZE - 1));
+        Executable *key = __atomic_load_n(&s->key, __ATOMIC_ACQUIRE);
+        if (key == e)
+        {
+            // Left over from an item dequeued while we were detached.
+            s->time = now;
+            return;
+        }
+        have_free |= !key;
+    }
+    for (unsigned i = 0; have_free && i < WAIT_PROBES; ++i)
+    {
+        WaitSlot *s = waitTable_ + ((first + i) & (WAIT_TABLE_SIZE - 1));
+        Executable *expected = nullptr;
+        if (__atomic_compare_exchange_n(&s->key, &expected, e, false,
+                __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            s->time = now;
+            return;
+        }
+    }
+    __atomic_fetch_add(&lostWaitSamples_, 1, __ATOMIC_RELAXED);
+}
+
+void ExecutorProfiler::record_dequeue(Executable *e, unsigned band, long long now)
+{
+    unsigned first = wait_slot(e);
+    for (unsigned i = 0; i < WAIT_PROBES; ++i)
+    {
+        WaitSlot *s = waitTable_ + ((first + i) & (WAIT_TABLE_SIZE - 1));
+        if (__atomic_load_n(&s->key, __ATOMIC_ACQUIRE) != e)
+        {
+            continue;
+        }
+        long long time = s->time;
+        __atomic_store_n(&s->key, nullptr, __ATOMIC_RELEASE);
+        if (band < MAX_BANDS)
+        {
+            AtomicHolder h(this);
+            waits_[band].add(now - time);
+        }
+        return;
+    }
+    // Enqueued while no profiler was attached, or the table was full.
+}
+
+ExecutorProfiler::Entry *ExecutorProfiler::lookup(Executable *e)
+{
+    // Only the executor thread modifies the table, so reading it does not
+    // need the lock.
+    unsigned mask = tableSize_ - 1;
+    unsigned idx = (((uintptr_t)e >> 3) * 2654435761u) & mask;
+    while (true)
+    {
+        Entry *entry = entries_ + idx;
+        if (entry->key == e)
+        {
+            return entry;
+        }
+        if (!entry->key)
+        {
+            break;
+        }
+        idx = (idx + 1) & mask;
+    }
+    if (numEntries_ >= maxEntries_)
+    {
+        return &other_;
+    }
+    AtomicHolder h(this);
+    Entry *entry = entries_ + idx;
+    entry->key = e;
+#ifdef __GXX_RTTI
+    entry->name = typeid(*e).name();
+#endif
+    ++numEntries_;
+    return entry;
+}
+
+void ExecutorProfiler::record_run(Entry *entry, long long nsec)
+{
+    {
+        AtomicHolder h(this);
+        entry->run.add(nsec);
+    }
+    check_signal();
+}
+
+void ExecutorProfiler::check_signal()
+{
+#ifdef PROFILER_SIGNAL
+    unsigned count = g_profiler_signal_count;
+    if (count != lastSignal_)
+    {
+        lastSignal_ = count;
+        print_report(stderr);
+    }
+#endif
+}
+
+ExecutorProfiler::Histogram ExecutorProfiler::run_stats(Executable *e)
+{
+    AtomicHolder h(this);
+    for (unsigned i = 0; i < tableSize_; ++i)
+    {
+        if (entries_[i].key == e)
+        {
+            return entries_[i].run;
+        }
+    }
+    Histogram ret;
+    memset(&ret, 0, sizeof(ret));
+    return ret;
+}
+
+ExecutorProfiler::Histogram ExecutorProfiler::wait_stats(unsigned band)
+{
+    HASSERT(band < MAX_BANDS);
+    AtomicHolder h(this);
+    return waits_[band];
+}
+
+/// Prints one line of the report. @param fp output. @param h statistics.
+static void print_histogram(FILE *fp, const ExecutorProfiler::Histogram &h)
+{
+    fprintf(fp, "%9u %9.3f %8u %8u %8u %8u", (unsigned)h.count,
+        h.totalNsec / 1e6, h.count ? (unsigned)(h.totalNsec / h.count / 1000) : 0,
+        h.percentile_usec(50), h.percentile_usec(99), (h.maxNsec + 999) / 1000);
+}
+
+void ExecutorProfiler::print_report(FILE *fp, unsigned top_n)
+{
+    std::vector<Entry> entries;
+    Histogram waits[MAX_BANDS];
+    unsigned lost;
+    {
+        AtomicHolder h(this);
+        entries.reserve(numEntries_ + 1);
+        for (unsigned i = 0; i < tableSize_; ++i)
+        {
+            if (entries_[i].key)
+            {
+                entries.push_back(entries_[i]);
+            }
+        }
+        if (other_.run.count)
+        {
+            entries.push_back(other_);
+        }
+        memcpy(waits, waits_, sizeof(waits));
+        lost = lost_wait_samples();
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.run.totalNsec > b.run.totalNsec;
+    });
+    fprintf(fp, "executor run time (usec unless noted):\n");
+    fprintf(fp, "%9s %9s %8s %8s %8s %8s  executable\n", "runs", "total_ms",
+        "avg", "p50", "p99", "max");
+    for (unsigned i = 0; i < entries.size() && i < top_n; ++i)
+    {
+        const Entry &e = entries[i];
+        print_histogram(fp, e.run);
+        if (!e.key)
+        {
+            fprintf(fp, "  (other)\n");
+            continue;
+        }
+        const char *name = e.name ? e.name : "";
+        char *demangled = nullptr;
+#ifdef PROFILER_DEMANGLE
+        int status = 0;
+        if (e.name)
+        {
+            demangled = abi::__cxa_demangle(e.name, nullptr, nullptr, &status);
+        }
+        if (demangled)
+        {
+            name = demangled;
+        }
+#endif
+        fprintf(fp, "  %p %s\n", e.key, name);
+        free(demangled);
+    }
+    fprintf(fp, "queue wait by priority band (usec unless noted):\n");
+    fprintf(fp, "%9s %9s %8s %8s %8s %8s  band\n", "items", "total_ms", "avg",
+        "p50", "p99", "max");
+    for (unsigned i = 0; i < MAX_BANDS; ++i)
+    {
+        if (!waits[i].count)
+        {
+            continue;
+        }
+        print_histogram(fp, waits[i]);
+        fprintf(fp, "  %u\n", i);
+    }
+    if (lost)
+    {
+        fprintf(fp, "%u queue wait samples lost\n", lost);
+    }
+}
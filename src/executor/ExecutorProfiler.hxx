@@ -0,0 +1,222 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file ExecutorProfiler.hxx
+ *
+ * Optional run-time and queue latency accounting for executors.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _EXECUTOR_EXECUTORPROFILER_HXX_
+#define _EXECUTOR_EXECUTORPROFILER_HXX_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "utils/Atomic.hxx"
+#include "utils/macros.h"
+
+class Executable;
+
+/// Collects statistics about an executor: how long each Executable ran, and
+/// how long items waited in the executor's queue in each priority band.
+///
+/// Usage:
+///
+///   ExecutorProfiler prof;
+///   executor.sync_run([&]() { executor.set_profiler(&prof); });
+///   console.add_command("prof", executor_profiler_command, &prof);
+///
+/// The report can be printed via print_report(), via the console command in
+/// console/ExecutorProfilerCommand.hxx, or (on POSIX hosts) by sending a
+/// signal registered with dump_on_signal().
+///
+/// When no profiler is attached, the executor pays one pointer test per
+/// executable. When attached, the cost is two clock reads and a lock per
+/// executable, plus one clock read and a compare-and-swap per enqueue; the
+/// producers do not serialize on a lock. A detached profiler may still be
+/// used by threads that were adding to the executor concurrently, so it
+/// should not be deleted while the executor is in use.
+///
+/// Queue wait is measured by keeping the enqueue timestamps in a small hash
+/// table keyed by the Executable, which is looked up and cleared on
+/// dequeue. An Executable is in the queue at most once, so the key is
+/// unique. Items that were enqueued while no profiler was attached are not
+/// measured. Samples are lost (and counted) if WAIT_PROBES neighboring slots
+/// of the table are all taken by items still in the queue.
+class ExecutorProfiler : private Atomic
+{
+public:
+    /// Number of buckets in a histogram. Bucket 0 counts events shorter than
+    /// 1 usec, bucket i counts [2^(i-1), 2^i) usec, the last bucket counts
+    /// everything longer.
+    static constexpr unsigned NUM_BUCKETS = 16;
+    /// How many priority bands we track queue wait for. Higher bands are not
+    /// tracked.
+    static constexpr unsigned MAX_BANDS = 4;
+    /// How many enqueue timestamps we remember. Power of two.
+    static constexpr unsigned WAIT_TABLE_SIZE = 256;
+    /// How many slots of the timestamp table an item may go to.
+    static constexpr unsigned WAIT_PROBES = 8;
+
+    /// Latency histogram with logarithmic buckets.
+    struct Histogram
+    {
+        /// Adds a sample. @param nsec the sample in nanoseconds.
+        void add(long long nsec);
+
+        /// @return an upper bound in usec of the given percentile of the
+        /// samples. @param pct is the percentile, 0..100.
+        uint32_t percentile_usec(unsigned pct) const;
+
+        /// Number of samples.
+        uint32_t count;
+        /// Largest sample, in nsec.
+        uint32_t maxNsec;
+        /// Sum of all samples, in nsec.
+        uint64_t totalNsec;
+        /// Sample counts by bucket.
+        uint32_t buckets[NUM_BUCKETS];
+    };
+
+    /// Statistics about one Executable.
+    struct Entry
+    {
+        /// Which executable this is about. nullptr for the entry collecting
+        /// all executables that did not fit into the table. If the
+        /// executable is deleted and another one is allocated at the same
+        /// address, the two are accounted together.
+        Executable *key;
+        /// Class name of the executable (when RTTI is available), or nullptr.
+        const char *name;
+        /// Run times.
+        Histogram run;
+    };
+
+    /// Constructor.
+    /// @param max_entries how many distinct Executables to track. Executables
+    /// beyond this are accounted together in one entry.
+    explicit ExecutorProfiler(unsigned max_entries = 64);
+
+    ~ExecutorProfiler();
+
+    /// Resets all statistics.
+    void clear();
+
+    /// Called by the executor before an item is added to its queue. May be
+    /// called from any thread, does not take a lock. @param e the item.
+    /// @param now current time from os_get_time_monotonic().
+    void record_enqueue(Executable *e, long long now);
+
+    /// Called by the executor when an item is taken off the queue. @param e
+    /// the item. @param band priority band the item was taken from. @param
+    /// now current time from os_get_time_monotonic().
+    void record_dequeue(Executable *e, unsigned band, long long now);
+
+    /// Called by the executor before running an Executable. The executable
+    /// may delete itself while running, so the entry must be looked up
+    /// beforehand. @param e the executable. @return entry to pass to
+    /// record_run.
+    Entry *lookup(Executable *e);
+
+    /// Called by the executor after an Executable returned. @param entry the
+    /// return value of lookup(). @param nsec how long the executable ran.
+    void record_run(Entry *entry, long long nsec);
+
+    /// Prints the top executables by total run time and the queue wait per
+    /// priority band. @param fp where to print. @param top_n how many
+    /// executables to list.
+    void print_report(FILE *fp, unsigned top_n = 10);
+
+    /// @return a copy of the statistics for the given executable, or a
+    /// histogram with zero count if it is not known. @param e executable.
+    Histogram run_stats(Executable *e);
+
+    /// @return a copy of the queue wait statistics for a priority
+    /// band. @param band priority band.
+    Histogram wait_stats(unsigned band);
+
+    /// @return how many queue wait samples were lost due to the timestamp
+    /// table overflowing.
+    unsigned lost_wait_samples()
+    {
+        return __atomic_load_n(&lostWaitSamples_, __ATOMIC_RELAXED);
+    }
+
+#if !defined(__FreeRTOS__) && !defined(ESP_NONOS) && !defined(__WINNT__)
+    /// Installs a signal handler that causes the report to be printed to
+    /// stderr (by the executor thread, at the next executable it runs).
+    /// @param signum signal number, e.g. SIGUSR2.
+    static void dump_on_signal(int signum);
+#endif
+
+private:
+    /// Enqueue timestamp of one item.
+    struct WaitSlot
+    {
+        /// The item in the queue, or nullptr if the slot is free. Claimed by
+        /// the producers with compare-and-swap, freed by the executor.
+        Executable *key;
+        /// Time the item was added to the queue. The queue orders the
+        /// producer's write before the executor's read.
+        long long time;
+    };
+
+    /// @return the first slot of the timestamp table for an
+    /// executable. @param e executable.
+    static unsigned wait_slot(Executable *e)
+    {
+        return (((uintptr_t)e >> 3) * 2654435761u) & (WAIT_TABLE_SIZE - 1);
+    }
+
+    /// Prints the report to stderr if a dump signal arrived.
+    void check_signal();
+
+    /// Number of slots in entries_. Power of two.
+    unsigned tableSize_;
+    /// How many slots of entries_ are used.
+    unsigned numEntries_;
+    /// Maximum value of numEntries_.
+    unsigned maxEntries_;
+    /// Open addressing hash table of executables.
+    Entry *entries_;
+    /// Collects the executables that did not fit.
+    Entry other_;
+    /// Enqueue timestamps of the items in the queue.
+    WaitSlot waitTable_[WAIT_TABLE_SIZE];
+    /// Queue wait by priority band.
+    Histogram waits_[MAX_BANDS];
+    /// Counts the wait samples we could not measure.
+    unsigned lostWaitSamples_;
+    /// Value of the signal counter when we last printed a report.
+    unsigned lastSignal_;
+
+    DISALLOW_COPY_AND_ASSIGN(ExecutorProfiler);
+};
+
+#endif // _EXECUTOR_EXECUTORPROFILER_HXX_
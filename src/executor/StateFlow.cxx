@@ -46,6 +46,8 @@ StateFlowWithQueue::StateFlowWithQueue(Service *service)
   : StateFlowBase(service)
   , queueSize_(0)
   , currentMessage_(nullptr)
+  , batchSize_(1)
+  , batchLeft_(1)
   , currentPriority_(MAX_PRIORITY_)
   , isWaiting_(1)
 {
@@ -98,12 +100,23 @@ StateFlowBase::Action StateFlowWithQueue::wait_for_message()
         isWaiting_ = 0;
         currentPriority_ = priority;
         queueSize_--;
+        if (batchLeft_ > 1 &&
+            !service()->executor()->has_higher_priority_work(priority))
+        {
+            // Continues with the next message in the same scheduling.
+            --batchLeft_;
+            return call_immediately(STATE(entry));
+        }
+        batchLeft_ = batchSize_;
         // Yielding here will ensure that we are processing the next message on
         // the current executor according to its priority.
         return yield_and_call(STATE(entry));
     }
     else
     {
+        // The first message after a wakeup always yields, in order to get
+        // onto the executor at the message's priority.
+        batchLeft_ = 1;
         isWaiting_ = 1;
         queueSize_ = 0;
         currentPriority_ = MAX_PRIORITY_;
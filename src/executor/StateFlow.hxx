@@ -919,6 +919,21 @@ public:
         return isWaiting_;
     }
 
+    /** Allows the flow to process up to n queued messages each time it gets
+     * scheduled on the executor, instead of going back through the executor
+     * queue after every message. Saves an executor round trip per message for
+     * high-rate flows, at the expense of other flows on the same executor
+     * waiting longer. The batch is cut short when the executor has work
+     * queued at a higher priority than the next message.
+     *
+     * @param n how many messages to process per scheduling; 1 (the default)
+     * yields after every message. At most 255. */
+    void set_batch_size(unsigned n)
+    {
+        HASSERT(n >= 1 && n <= 255);
+        batchSize_ = n;
+    }
+
 protected:
     /// Constructor. @param service specifies which thread to execute this
     /// state flow on.
@@ -1030,6 +1045,11 @@ private:
     /// Message we are currently processing.
     BufferBase *currentMessage_;
 
+    /// How many messages to process per scheduling on the executor.
+    uint8_t batchSize_;
+    /// How many more messages we may process before yielding.
+    uint8_t batchLeft_;
+
     /// Priority of the current message we are processing.
     unsigned currentPriority_ : 31;
 
@@ -82,9 +82,10 @@ void ActiveTimers::run()
     // call.
 }
 
-long long ActiveTimers::get_next_timeout()
+long long ActiveTimers::get_next_timeout_locked()
 {
     OSMutexLock l(&lock_);
+    __atomic_store_n(&dirty_, 0, __ATOMIC_RELAXED);
 
     QMember **last = &activeTimers_.next;
     Timer *current_timer = static_cast<Timer *>(*last);
@@ -105,21 +106,21 @@ long long ActiveTimers::get_next_timeout()
         current_timer = static_cast<Timer *>(*last);
     }
 
-    if (found_timer)
-    {
-        return 0;
-    }
-    else if (current_timer)
+    if (current_timer)
     {
-        long long ret = current_timer->when_ - now;
-        return ret;
+        nextDeadline_ = current_timer->when_;
     }
     else
     {
         // Wakes up the timer service every now and then. It won't make any
         // difference.
-        return SEC_TO_NSEC(3600);
+        nextDeadline_ = now + SEC_TO_NSEC(3600);
+    }
+    if (found_timer)
+    {
+        return 0;
     }
+    return nextDeadline_ - now;
 }
 
 void ActiveTimers::schedule_timer(Timer *timer)
@@ -143,6 +144,9 @@ void ActiveTimers::insert_locked(Timer *timer)
     // Inserts into the queue.
     timer->next = current_timer;
     *last = timer;
+    // The new timer may expire before the cached deadline. Removing a timer
+    // can only make the cached deadline early, which is harmless.
+    __atomic_store_n(&dirty_, 1, __ATOMIC_RELEASE);
 
     // This will wake up the executor, which will schedule all expired timers
     // and recompute sleep length.
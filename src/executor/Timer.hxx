@@ -53,6 +53,8 @@ public:
     /// @param executor parent that will use this instance.
     ActiveTimers(ExecutorBase *executor)
         : executor_(executor)
+        , nextDeadline_(0)
+        , dirty_(1)
         , isPending_(0)
     {
     }
@@ -60,10 +62,25 @@ public:
     ~ActiveTimers();
 
     /** Tell when the first timer will expire. If there are no active timers,
-     * returns a large number.
+     * returns a large number. Must be called on the executor thread.
+     *
+     * When no timer is due and the timer list did not change since the last
+     * call, this only reads the clock and does not take the lock.
+     *
      * @returns the timer in nanoseconds to sleep until the next timer to wake
      * up. Can return 0 if there is an expired timer. */
-    long long get_next_timeout();
+    long long get_next_timeout()
+    {
+        if (!__atomic_load_n(&dirty_, __ATOMIC_ACQUIRE))
+        {
+            long long now = OSTime::get_monotonic();
+            if (now < nextDeadline_)
+            {
+                return nextDeadline_ - now;
+            }
+        }
+        return get_next_timeout_locked();
+    }
 
     /** Adds a new timer to the active timer list. It is OK to schedule a timer
      * that is already expired, which will then wake up the executor.
@@ -101,6 +118,10 @@ public:
     void run() override;
 
 private:
+    /** Takes the lock, schedules all expired timers and recomputes
+     * nextDeadline_. @returns same as get_next_timeout(). */
+    long long get_next_timeout_locked();
+
     /** Removes a timer from the active list. Assert fails if it is not
      * there. Caller must hold the lock. 
      * @param timer what to remove from the active list. */
@@ -116,6 +137,12 @@ private:
     OSMutex lock_;
     /// List of timers that are scheduled.
     QMember activeTimers_;
+    /// Expiration time of the first active timer, as of the last
+    /// get_next_timeout_locked() call. Accessed only by the executor thread.
+    long long nextDeadline_;
+    /// 1 if a timer was inserted since nextDeadline_ was computed, so it may
+    /// be too late. Written with the lock held, read without the lock.
+    unsigned dirty_;
     /// 1 if we in the executor's queue.
     unsigned isPending_ : 1;
 
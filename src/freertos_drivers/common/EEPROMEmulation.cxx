@@ -115,6 +115,34 @@ void EEPROMEmulation::mount()
         /* turn on shadowing */
         shadowInRam_ = true;
     }
+    else if (INDEX_IN_RAM)
+    {
+        index_ = new uint16_t[fblock_count()];
+        rebuild_index();
+    }
+}
+
+/** Fills in the index_ array from the journal in the active sector.
+ */
+void EEPROMEmulation::rebuild_index()
+{
+    memset(index_, 0, fblock_count() * sizeof(index_[0]));
+
+    /* the journal is append-only, so later slots override earlier ones */
+    for (unsigned raw_block = slot_first(); raw_block <= slot_last();
+         ++raw_block)
+    {
+        const uint32_t *address = block(activeSector_, raw_block);
+        if (*address == MAGIC_ERASED)
+        {
+            break;
+        }
+        unsigned fblock = address[0] >> 16;
+        if (fblock < fblock_count())
+        {
+            index_[fblock] = raw_block;
+        }
+    }
 }
 
 /** Write to the EEPROM.  NOTE!!! This is not necessarily atomic across
@@ -213,6 +241,10 @@ void EEPROMEmulation::write_fblock(unsigned int index, const uint8_t data[])
                            (data[(i * 2) + 0] << 0);
         }
         flash_program(activeSector_, rawBlockCount_ - availableSlots_, slot_data, BLOCK_SIZE);
+        if (index_)
+        {
+            index_[index] = rawBlockCount_ - availableSlots_;
+        }
         --availableSlots_;
     }
     else
@@ -259,6 +291,12 @@ void EEPROMEmulation::write_fblock(unsigned int index, const uint8_t data[])
             }
             /* commit the write */
             flash_program(new_sector, rawBlockCount_ - available_slots, slot_data, BLOCK_SIZE);
+            if (index_)
+            {
+                /* Each fblock is visited only once, so the reads for the
+                 * remaining fblocks still see the old sector's slots. */
+                index_[fblock] = rawBlockCount_ - available_slots;
+            }
             --available_slots;
         }
         /* finalize the data move and write */
@@ -287,6 +325,25 @@ void EEPROMEmulation::read(unsigned int offset, void *buf, size_t len)
     }
 
     uint8_t *byte_data = (uint8_t *)buf;
+
+    if (index_)
+    {
+        while (len)
+        {
+            uint8_t data[BYTES_PER_BLOCK];
+            unsigned int lsa = offset & (BYTES_PER_BLOCK - 1);
+            size_t copy_size = len < (BYTES_PER_BLOCK - lsa) ?
+                               len : (BYTES_PER_BLOCK - lsa);
+            read_fblock(offset / BYTES_PER_BLOCK, data);
+            memcpy(byte_data, data + lsa, copy_size);
+
+            offset    += copy_size;
+            len       -= copy_size;
+            byte_data += copy_size;
+        }
+        return;
+    }
+
     memset(byte_data, 0xff, len); // default if data not found
 
     for (unsigned block_index = slot_first();
@@ -354,6 +411,18 @@ bool EEPROMEmulation::read_fblock(unsigned int index, uint8_t data[])
         }
         return false;
     }
+    else if (index_)
+    {
+        memset(data, 0xFF, BYTES_PER_BLOCK);
+        unsigned raw_block = index_[index];
+        if (!raw_block)
+        {
+            /* never written */
+            return false;
+        }
+        decode_slot(block(activeSector_, raw_block), data);
+        return true;
+    }
     else
     {
         /* default data value if not found */
@@ -101,6 +101,12 @@ extern const char __eeprom_end;
  *  be allocated in RAM that will be pre-filled with the entire eeprom
  *  data. Dramatically speeds up reads, because reads will not have to go
  *  through the log anymore.
+ *  @param INDEX_IN_RAM: a boolean, if set to true (and SHADOW_IN_RAM is
+ *  false), an index_ array will be allocated in RAM that stores for every
+ *  data block of the eeprom file the slot in the active sector holding the
+ *  newest copy. Reads become a single lookup instead of a journal scan. Costs
+ *  2 bytes of RAM per BYTES_PER_BLOCK bytes of file, which is less than the
+ *  shadow when BYTES_PER_BLOCK > 2.
  *  @param file_size: The total number of bytes held by the emulated eeprom
  *  file. Reads from address 0 .. file_size - 1 will be valid. Must be smaller
  *  than half of one sector, but should be realistically about 35% of the
@@ -142,6 +148,8 @@ protected:
      */
     ~EEPROMEmulation()
     {
+        delete[] shadow_;
+        delete[] index_;
     }
 
     /** Mount the EEPROM file.  Should be called during construction of the
@@ -196,6 +204,12 @@ private:
      */
     static const bool SHADOW_IN_RAM;
 
+    /** Keep an index in RAM of the newest journal slot for every data
+     * block. This will increase read performance at the expense of a small
+     * amount of RAM. Ignored if SHADOW_IN_RAM is set.
+     */
+    static const bool INDEX_IN_RAM;
+
 protected:
     /** magic marker for an intact block */
     static const uint32_t MAGIC_INTACT;
@@ -237,6 +251,23 @@ private:
      */
     bool read_fblock(unsigned int index, uint8_t data[]);
 
+    /** Fills in the index_ array from the journal in the active sector. */
+    void rebuild_index();
+
+    /** Decodes the data payload of a slot.
+     * @param address pointer to the slot in flash
+     * @param data location to place the payload, array size must be @ref
+     *           BYTES_PER_BLOCK large
+     */
+    static void decode_slot(const uint32_t *address, uint8_t data[])
+    {
+        for (unsigned int i = 0; i < BLOCK_SIZE / sizeof(uint32_t); ++i)
+        {
+            data[(i * 2) + 0] = (address[i] >> 0) & 0xFF;
+            data[(i * 2) + 1] = (address[i] >> 8) & 0xFF;
+        }
+    }
+
     /** Get the next active sector pointer.
      * @return sector index for the next sector to use.
      */
@@ -264,6 +295,14 @@ private:
         return rawBlockCount_ - MAGIC_COUNT;
     }
 
+    /** Number of data blocks in the emulated eeprom file.
+     * @return number of BYTES_PER_BLOCK sized blocks covering file_size()
+     */
+    unsigned fblock_count()
+    {
+        return (file_size() + BYTES_PER_BLOCK - 1) / BYTES_PER_BLOCK;
+    }
+
     /**
      * @return raw block index of the last block containing user data.
      */
@@ -324,6 +363,12 @@ protected:
     /** pointer to RAM for shadowing EEPROM. */
     uint8_t *shadow_{nullptr};
 
+    /** Index of the newest slot in the active sector for each data block of
+     * the file, or zero if the block was never written. Zero is safe as a
+     * marker because raw block 0 is always a magic block. nullptr if the
+     * index is not used. */
+    uint16_t *index_{nullptr};
+
 
     /** Default constructor.
      */
@@ -0,0 +1,207 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file CompiledCdi.hxx
+ *
+ * Renders the cdi.xml and the event offset table of a configuration
+ * definition at compile time.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _OPENLCB_COMPILEDCDI_HXX_
+#define _OPENLCB_COMPILEDCDI_HXX_
+
+#include "openlcb/ConfigRepresentation.hxx"
+
+#ifdef HAVE_CONSTEXPR_CDI
+
+namespace openlcb
+{
+
+/// Output sink for rendering the cdi.xml in a constant expression. Stores the
+/// first N - 1 characters and a terminating null. Characters beyond that are
+/// only counted, which allows sizing the final buffer in a first pass.
+template <unsigned N> class ConstexprCdiBuffer
+{
+public:
+    constexpr ConstexprCdiBuffer()
+        : data_ {}
+        , length_(0)
+    {
+    }
+
+    /// Appends a null-terminated string to the output.
+    constexpr void append(const char *s)
+    {
+        for (; *s; ++s, ++length_)
+        {
+            if (length_ + 1 < N)
+            {
+                data_[length_] = *s;
+            }
+        }
+    }
+
+    /// @return the rendered data, null-terminated.
+    constexpr const char *data() const
+    {
+        return data_;
+    }
+
+    /// @return the number of characters rendered, not counting the
+    /// terminating null. May be more than what fit into the buffer.
+    constexpr unsigned length() const
+    {
+        return length_;
+    }
+
+private:
+    /// Rendered characters.
+    char data_[N];
+    /// How many characters were appended.
+    unsigned length_;
+};
+
+/// Callback for handle_events() that collects the event offsets in a constant
+/// expression. Stores up to N - 1 offsets followed by a terminating zero,
+/// which is the same layout as CDI_EVENT_OFFSETS.
+template <unsigned N> class ConstexprEventOffsets
+{
+public:
+    constexpr ConstexprEventOffsets()
+        : data_ {}
+        , count_(0)
+    {
+    }
+
+    /// Records the offset of one event ID in the configuration space.
+    constexpr void operator()(unsigned offset)
+    {
+        if (count_ + 1 < N)
+        {
+            data_[count_] = offset;
+        }
+        ++count_;
+    }
+
+    /// @return the zero-terminated array of event offsets.
+    constexpr const uint16_t *data() const
+    {
+        return data_;
+    }
+
+    /// @return the number of event offsets seen.
+    constexpr unsigned count() const
+    {
+        return count_;
+    }
+
+private:
+    /// Collected event offsets.
+    uint16_t data_[N];
+    /// How many event offsets were seen.
+    unsigned count_;
+};
+
+namespace compiled_cdi_detail
+{
+
+/// Renders the cdi.xml of a given type into an output sink.
+template <class W, class CdiType> constexpr W render()
+{
+    W w;
+    CdiType::config_renderer().render_cdi(&w);
+    return w;
+}
+
+/// Collects the event offsets of a given config definition.
+template <class F, class CdiType> constexpr F collect_events()
+{
+    F f;
+    CdiType(0).handle_events(f);
+    return f;
+}
+
+} // namespace compiled_cdi_detail
+
+/// The cdi.xml and the event offsets of a configuration definition, computed
+/// by the compiler. This is the same data that CompileCdiMain.cxx exports as
+/// CDI_DATA and CDI_EVENT_OFFSETS, but needs no host-side rendering step and
+/// lands in read-only memory. A SimpleCanStack serves it after
+///
+///   stack.use_compiled_cdi<openlcb::ConfigDef>();
+///
+/// Other nodes can export it directly:
+///
+///   using Cdi = CompiledCdi<ConfigDef>;
+///   new ReadOnlyMemoryBlock(Cdi::DATA.data(), Cdi::SIZE);
+///
+/// If the CDI contains an Identification entry, SNIP_STATIC_DATA has to be
+/// defined as constexpr in the config.hxx.
+///
+/// @param CdiType is a CDI_GROUP with MainCdi() (or any other group).
+template <class CdiType> class CompiledCdi
+{
+public:
+    /// Number of bytes in the cdi.xml including the terminating null.
+    static constexpr unsigned SIZE =
+        compiled_cdi_detail::render<ConstexprCdiBuffer<1>, CdiType>()
+            .length() +
+        1;
+    /// Number of event IDs in the configuration space.
+    static constexpr unsigned NUM_EVENTS =
+        compiled_cdi_detail::collect_events<ConstexprEventOffsets<1>,
+            CdiType>()
+            .count();
+    /// The rendered cdi.xml.
+    static constexpr ConstexprCdiBuffer<SIZE> DATA =
+        compiled_cdi_detail::render<ConstexprCdiBuffer<SIZE>, CdiType>();
+    /// Offsets of all event IDs in the configuration space, terminated by a
+    /// zero.
+    static constexpr ConstexprEventOffsets<NUM_EVENTS + 1> EVENT_OFFSETS =
+        compiled_cdi_detail::collect_events<
+            ConstexprEventOffsets<NUM_EVENTS + 1>, CdiType>();
+};
+
+template <class CdiType> constexpr unsigned CompiledCdi<CdiType>::SIZE;
+
+template <class CdiType> constexpr unsigned CompiledCdi<CdiType>::NUM_EVENTS;
+
+template <class CdiType>
+constexpr ConstexprCdiBuffer<CompiledCdi<CdiType>::SIZE>
+    CompiledCdi<CdiType>::DATA;
+
+template <class CdiType>
+constexpr ConstexprEventOffsets<CompiledCdi<CdiType>::NUM_EVENTS + 1>
+    CompiledCdi<CdiType>::EVENT_OFFSETS;
+
+} // namespace openlcb
+
+#endif // HAVE_CONSTEXPR_CDI
+
+#endif // _OPENLCB_COMPILEDCDI_HXX_
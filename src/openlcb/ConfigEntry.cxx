@@ -34,15 +34,157 @@
 
 #include "openlcb/ConfigEntry.hxx"
 
+#include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
+#if defined(__linux__) || defined(__MACH__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define CONFIG_CACHE_HAVE_MMAP
+#endif
 #include "utils/logging.h"
 
 namespace openlcb
 {
 
+ConfigReadCache *ConfigReadCache::current_ = nullptr;
+os_thread_t ConfigReadCache::owner_;
+
+ConfigReadCache::ConfigReadCache(int fd, unsigned offset, unsigned size)
+    : data_(new uint8_t[size])
+    , base_(data_.get())
+    , fd_(fd)
+    , offset_(offset)
+    , size_(0)
+{
+    int ret = lseek(fd, offset, SEEK_SET);
+    ERRNOCHECK("seek_config", ret);
+    while (size_ < size)
+    {
+        ssize_t ret = ::read(fd, data_.get() + size_, size - size_);
+        ERRNOCHECK("read_config", ret);
+        if (ret == 0)
+        {
+            // The file is shorter. Reads past the end will not be cached.
+            break;
+        }
+        size_ += ret;
+    }
+}
+
+ConfigReadCache::ConfigReadCache(int fd)
+    : base_(nullptr)
+    , fd_(fd)
+    , offset_(0)
+    , size_(0)
+{
+#ifdef CONFIG_CACHE_HAVE_MMAP
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+    {
+        return;
+    }
+    void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (m == MAP_FAILED)
+    {
+        return;
+    }
+    base_ = static_cast<const uint8_t *>(m);
+    size_ = st.st_size;
+#endif
+}
+
+ConfigReadCache::~ConfigReadCache()
+{
+    uninstall();
+#ifdef CONFIG_CACHE_HAVE_MMAP
+    if (mapped())
+    {
+        munmap(const_cast<uint8_t *>(base_), size_);
+    }
+#endif
+}
+
+void ConfigReadCache::install()
+{
+    ConfigReadCache *expected = nullptr;
+    if (!__atomic_compare_exchange_n(&current_, &expected, this, false,
+            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        // Some other cache is installed; this one stays unused.
+        return;
+    }
+    __atomic_store_n(&owner_, os_thread_self(), __ATOMIC_RELEASE);
+}
+
+void ConfigReadCache::uninstall()
+{
+    if (__atomic_load_n(&current_, __ATOMIC_ACQUIRE) != this)
+    {
+        return;
+    }
+    // The owner is cleared first, so that no other thread can take the slot
+    // while owner_ still names this thread.
+    __atomic_store_n(&owner_, os_thread_t(), __ATOMIC_RELEASE);
+    __atomic_store_n(&current_, (ConfigReadCache *)nullptr, __ATOMIC_RELEASE);
+}
+
+ConfigReadCache *ConfigReadCache::installed(int fd)
+{
+    // Other threads' caches may be destroyed at any time, so current_ must
+    // not be dereferenced unless it belongs to this thread.
+    if (__atomic_load_n(&owner_, __ATOMIC_ACQUIRE) != os_thread_self())
+    {
+        return nullptr;
+    }
+    ConfigReadCache *c = __atomic_load_n(&current_, __ATOMIC_ACQUIRE);
+    if (!c || c->fd_ != fd)
+    {
+        return nullptr;
+    }
+    return c;
+}
+
+bool ConfigReadCache::read(int fd, unsigned offset, void *buf, size_t size)
+{
+    ConfigReadCache *c = installed(fd);
+    if (!c || !c->covers(offset, size))
+    {
+        return false;
+    }
+    memcpy(buf, c->base_ + offset - c->offset_, size);
+    return true;
+}
+
+void ConfigReadCache::write(
+    int fd, unsigned offset, const void *buf, size_t size)
+{
+    ConfigReadCache *c = installed(fd);
+    if (!c || c->mapped())
+    {
+        // A shared mapping sees the write already.
+        return;
+    }
+    // Copies the part of the written range that overlaps the cache.
+    unsigned begin = offset > c->offset_ ? offset : c->offset_;
+    unsigned end = offset + size;
+    if (end > c->offset_ + c->size_)
+    {
+        end = c->offset_ + c->size_;
+    }
+    if (begin < end)
+    {
+        memcpy(c->data_.get() + begin - c->offset_,
+            static_cast<const uint8_t *>(buf) + begin - offset, end - begin);
+    }
+}
+
 void ConfigEntryBase::repeated_read(int fd, void *buf, size_t size) const
 {
+    if (ConfigReadCache::read(fd, offset_, buf, size))
+    {
+        return;
+    }
     int ret = lseek(fd, offset_, SEEK_SET);
     ERRNOCHECK("seek_config", ret);
     uint8_t *dst = static_cast<uint8_t *>(buf);
@@ -61,6 +203,7 @@ void ConfigEntryBase::repeated_read(int fd, void *buf, size_t size) const
 
 void ConfigEntryBase::repeated_write(int fd, const void *buf, size_t size) const
 {
+    ConfigReadCache::write(fd, offset_, buf, size);
     int ret = lseek(fd, offset_, SEEK_SET);
     ERRNOCHECK("seek_config", ret);
     const uint8_t *dst = static_cast<const uint8_t *>(buf);
@@ -40,8 +40,10 @@
 #include <endian.h>
 
 #include <functional>
+#include <memory>
 
 #include "openlcb/ConfigRenderer.hxx"
+#include "os/os.h"
 
 namespace openlcb
 {
@@ -79,8 +81,107 @@ protected:
     unsigned offset_;
 };
 
+/// A snapshot of (a range of) the configuration file in memory. While an
+/// instance is installed, the config entries' read() calls made on the
+/// installing thread are served from memory instead of one lseek and read
+/// syscall per field. Writes through the config entries on the installing
+/// thread are applied to both the file and the snapshot. The ConfigUpdateFlow installs one while calling
+/// the update listeners.
+///
+/// The snapshot is either a copy in RAM, or on hosts with mmap, a read-only
+/// mapping of the whole file.
+class ConfigReadCache
+{
+public:
+    /// Reads a range of the config file into memory. Does not install the
+    /// cache.
+    ///
+    /// @param fd is the config file.
+    /// @param offset is the first byte to read.
+    /// @param size is the number of bytes to read.
+    ConfigReadCache(int fd, unsigned offset, unsigned size);
+
+    /// Maps the entire config file into memory. Does not install the
+    /// cache. If the operating system or the file does not support this, the
+    /// cache will be empty (size() == 0).
+    ///
+    /// @param fd is the config file.
+    explicit ConfigReadCache(int fd);
+
+    ~ConfigReadCache();
+
+    /// Makes the config entries use this cache on the current thread. Only
+    /// one cache can be installed at a time; if another one is installed
+    /// (by any thread), this call does nothing and the config entries keep
+    /// reading the file.
+    void install();
+
+    /// Undoes install().
+    void uninstall();
+
+    /// Reads from the installed cache.
+    ///
+    /// @return false if there is no cache installed for the current thread,
+    /// or it does not cover the given range.
+    static bool read(int fd, unsigned offset, void *buf, size_t size);
+
+    /// Updates the installed cache with data that was just written to the
+    /// file.
+    static void write(int fd, unsigned offset, const void *buf, size_t size);
+
+    /// @return the first byte in the cache.
+    unsigned offset()
+    {
+        return offset_;
+    }
+
+    /// @return the number of bytes in the cache.
+    unsigned size()
+    {
+        return size_;
+    }
+
+    /// @return true if the cache contains the given range.
+    /// @param offset is the first byte of the range.
+    /// @param size is the number of bytes in the range.
+    bool covers(unsigned offset, size_t size)
+    {
+        return offset >= offset_ && offset + size <= offset_ + size_;
+    }
+
+    /// @return true if this cache is a memory mapping of the file.
+    bool mapped()
+    {
+        return !data_ && size_;
+    }
+
+private:
+    /// @return the cache installed by the current thread if it is for the
+    /// given file, otherwise nullptr.
+    static ConfigReadCache *installed(int fd);
+
+    /// Currently installed cache, or nullptr. Accessed atomically.
+    static ConfigReadCache *current_;
+    /// Which thread installed current_. Accessed atomically. Checked before
+    /// current_ is dereferenced.
+    static os_thread_t owner_;
+
+    /// Copy of the file contents when not mapped.
+    std::unique_ptr<uint8_t[]> data_;
+    /// Snapshot contents: either data_ or the mapping of the file.
+    const uint8_t *base_;
+    /// File that the copy was taken of.
+    int fd_;
+    /// Offset in the file of base_[0].
+    unsigned offset_;
+    /// Number of bytes in base_.
+    unsigned size_;
+};
+
 /// Function declaration that will be called with all event offsets that exist
-/// in the configuration space.
+/// in the configuration space. The handle_events() calls accept any other
+/// callable too; a literal type with a constexpr operator() allows collecting
+/// the event offsets at compile time.
 typedef std::function<void(unsigned)> EventOffsetCallback;
 
 ///
@@ -97,7 +198,9 @@ public:
         return GroupConfigOptions();
     }
 
-    static void handle_events(const EventOffsetCallback& fn) {}
+    template <class F> static CDI_CONSTEXPR void handle_events(F &&fn)
+    {
+    }
 
 protected:
     /// Reads a given typed variable from the configuration file. DOes not do
@@ -258,7 +361,8 @@ public:
         return AtomConfigRenderer("eventid", AtomConfigRenderer::SKIP_SIZE);
     }
 
-    void handle_events(const EventOffsetCallback& fn) {
+    template <class F> CDI_CONSTEXPR void handle_events(F &&fn) const
+    {
         fn(offset());
     }
 };
@@ -42,9 +42,58 @@
 #include "utils/OptionalArgs.hxx"
 #include "utils/StringPrintf.hxx"
 
+#if __cplusplus >= 201402L
+/// The CDI renderers are usable in constant expressions. This needs the
+/// relaxed constexpr rules of C++14; with C++11 they are regular functions.
+#define CDI_CONSTEXPR constexpr
+/// Defined when the cdi.xml can be rendered at compile time.
+#define HAVE_CONSTEXPR_CDI 1
+#else
+#define CDI_CONSTEXPR
+#endif
+
 namespace openlcb
 {
 
+/// Appends the decimal representation of a number to a rendered cdi.xml.
+///
+/// @param s is the output; either a std::string or any other class with an
+/// append(const char*) method.
+/// @param value is the number to render.
+template <class W> CDI_CONSTEXPR void cdi_append_number(W *s, long long value)
+{
+    char buf[24] = {0};
+    unsigned p = sizeof(buf) - 1;
+    unsigned long long v = value < 0 ? -(unsigned long long)value : value;
+    do
+    {
+        buf[--p] = '0' + (v % 10);
+        v /= 10;
+    } while (v);
+    if (value < 0)
+    {
+        buf[--p] = '-';
+    }
+    s->append(buf + p);
+}
+
+/// Appends "<tag>value</tag>\n" to a rendered cdi.xml.
+///
+/// @param s is the output.
+/// @param tag is the name of the xml element.
+/// @param value is the (already escaped) content of the element.
+template <class W>
+CDI_CONSTEXPR void cdi_append_element(W *s, const char *tag, const char *value)
+{
+    s->append("<");
+    s->append(tag);
+    s->append(">");
+    s->append(value);
+    s->append("</");
+    s->append(tag);
+    s->append(">\n");
+}
+
 /// Configuration options for rendering CDI (atom) data elements.
 struct AtomConfigDefs
 {
@@ -69,20 +118,19 @@ public:
     /// Represent the value enclosed in the "<map>" tag of the data element.
     DEFINE_OPTIONALARG(MapValues, mapvalues, const char *);
 
-    void render_cdi(std::string *r) const
+    template <class W> CDI_CONSTEXPR void render_cdi(W *r) const
     {
         if (name())
         {
-            *r += StringPrintf("<name>%s</name>\n", name());
+            cdi_append_element(r, "name", name());
         }
         if (description())
         {
-            *r +=
-                StringPrintf("<description>%s</description>\n", description());
+            cdi_append_element(r, "description", description());
         }
         if (mapvalues())
         {
-            *r += StringPrintf("<map>%s</map>\n", mapvalues());
+            cdi_append_element(r, "map", mapvalues());
         }
     }
 };
@@ -104,16 +152,22 @@ public:
     {
     }
 
-    template <typename... Args> void render_cdi(string *s, Args... args) const
+    template <class W, typename... Args>
+    CDI_CONSTEXPR void render_cdi(W *s, Args... args) const
     {
-        *s += StringPrintf("<%s", tag_);
+        s->append("<");
+        s->append(tag_);
         if (size_ != SKIP_SIZE)
         {
-            *s += StringPrintf(" size=\'%u\'", size_);
+            s->append(" size='");
+            cdi_append_number(s, size_);
+            s->append("'");
         }
-        *s += ">\n";
+        s->append(">\n");
         AtomConfigOptions(args...).render_cdi(s);
-        *s += StringPrintf("</%s>\n", tag_);
+        s->append("</");
+        s->append(tag_);
+        s->append(">\n");
     }
 
 private:
@@ -153,35 +207,47 @@ public:
     DEFINE_OPTIONALARG(Max, maxvalue, int);
     DEFINE_OPTIONALARG(Default, defaultvalue, int);
 
-    void render_cdi(std::string *r) const
+    template <class W> CDI_CONSTEXPR void render_cdi(W *r) const
     {
         if (name())
         {
-            *r += StringPrintf("<name>%s</name>\n", name());
+            cdi_append_element(r, "name", name());
         }
         if (description())
         {
-            *r +=
-                StringPrintf("<description>%s</description>\n", description());
+            cdi_append_element(r, "description", description());
         }
         if (minvalue() != INT_MAX)
         {
-            *r += StringPrintf("<min>%d</min>\n", minvalue());
+            render_number(r, "min", minvalue());
         }
         if (maxvalue() != INT_MAX)
         {
-            *r += StringPrintf("<max>%d</max>\n", maxvalue());
+            render_number(r, "max", maxvalue());
         }
         if (defaultvalue() != INT_MAX)
         {
-            *r += StringPrintf("<default>%d</default>\n", defaultvalue());
+            render_number(r, "default", defaultvalue());
         }
         if (mapvalues())
         {
-            *r += StringPrintf("<map>%s</map>\n", mapvalues());
+            cdi_append_element(r, "map", mapvalues());
         }
     }
 
+    /// Appends "<tag>value</tag>\n" with a numeric value.
+    template <class W>
+    static CDI_CONSTEXPR void render_number(W *r, const char *tag, int value)
+    {
+        r->append("<");
+        r->append(tag);
+        r->append(">");
+        cdi_append_number(r, value);
+        r->append("</");
+        r->append(tag);
+        r->append(">\n");
+    }
+
     int clip(int value) {
         if (has_minvalue() && (value < minvalue())) {
             value = minvalue();
@@ -210,16 +276,22 @@ public:
     {
     }
 
-    template <typename... Args> void render_cdi(string *s, Args... args) const
+    template <class W, typename... Args>
+    CDI_CONSTEXPR void render_cdi(W *s, Args... args) const
     {
-        *s += StringPrintf("<%s", tag_);
+        s->append("<");
+        s->append(tag_);
         if (size_ != SKIP_SIZE)
         {
-            *s += StringPrintf(" size=\'%u\'", size_);
+            s->append(" size='");
+            cdi_append_number(s, size_);
+            s->append("'");
         }
-        *s += ">\n";
+        s->append(">\n");
         NumericConfigOptions(args...).render_cdi(s);
-        *s += StringPrintf("</%s>\n", tag_);
+        s->append("</");
+        s->append(tag_);
+        s->append(">\n");
     }
 
 private:
@@ -310,21 +382,19 @@ public:
         return offset() == INT_MAX ? 0 : offset();
     }
 
-    void render_cdi(std::string *r) const
+    template <class W> CDI_CONSTEXPR void render_cdi(W *r) const
     {
         if (name())
         {
-            *r += StringPrintf("<name>%s</name>\n", name());
+            cdi_append_element(r, "name", name());
         }
         if (description())
         {
-            *r +=
-                StringPrintf("<description>%s</description>\n", description());
+            cdi_append_element(r, "description", description());
         }
         if (repname())
         {
-            *r +=
-                StringPrintf("<repname>%s</repname>\n", repname());
+            cdi_append_element(r, "repname", repname());
         }
     }
 };
@@ -345,9 +415,11 @@ public:
     {
     }
 
-    void render_cdi(string *s) const
+    template <class W> CDI_CONSTEXPR void render_cdi(W *s) const
     {
-        *s += StringPrintf("<group offset='%u'/>", size_);
+        s->append("<group offset='");
+        cdi_append_number(s, size_);
+        s->append("'/>");
     }
 
 private:
@@ -369,19 +441,20 @@ public:
     {
     }
 
-    template <typename... Args> void render_cdi(string *s, Args... args)
+    template <class W, typename... Args>
+    CDI_CONSTEXPR void render_cdi(W *s, Args... args) const
     {
         GroupConfigOptions opts(args..., Body::group_opts());
         const char *tag = nullptr;
-        *s += "<";
+        s->append("<");
         if (opts.is_cdi())
         {
-            *s += "?xml version=\"1.0\"?>\n<";
+            s->append("?xml version=\"1.0\"?>\n<");
             tag = "cdi";
-            *s += tag;
-            *s += " xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+            s->append(tag);
+            s->append(" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
                   "xsi:noNamespaceSchemaLocation=\"http://openlcb.org/schema/"
-                  "cdi/1/1/cdi.xsd\"";
+                      "cdi/1/1/cdi.xsd\"");
             HASSERT(replication_ == 1);
             HASSERT(opts.name() == nullptr && opts.description() == nullptr);
         }
@@ -389,32 +462,41 @@ public:
         {
             // Regular group
             tag = "group";
-            *s += tag;
+            s->append(tag);
             if (replication_ != 1)
             {
-                *s += StringPrintf(" replication='%u'", replication_);
+                s->append(" replication='");
+                cdi_append_number(s, replication_);
+                s->append("'");
             }
         }
         else
         {
             // Segment inside CDI.
             tag = "segment";
-            *s += tag;
-            *s += StringPrintf(" space='%d'", opts.segment());
+            s->append(tag);
+            s->append(" space='");
+            cdi_append_number(s, opts.segment());
+            s->append("'");
             if (opts.get_segment_offset() != 0)
             {
-                *s += StringPrintf(" origin='%d'", opts.get_segment_offset());
+                s->append(" origin='");
+                cdi_append_number(s, (int)opts.get_segment_offset());
+                s->append("'");
             }
             HASSERT(replication_ == 1);
         }
-        *s += ">\n";
+        s->append(">\n");
         opts.render_cdi(s);
         body_.render_content_cdi(s);
         if (opts.fixed_size() && (body_.end_buffer_length() > 0)) {
-            *s += StringPrintf(
-                "<group offset='%u'/>\n", body_.end_buffer_length());
+            s->append("<group offset='");
+            cdi_append_number(s, body_.end_buffer_length());
+            s->append("'/>\n");
         }
-        *s += StringPrintf("</%s>\n", tag);
+        s->append("</");
+        s->append(tag);
+        s->append(">\n");
     }
 
 private:
@@ -462,31 +544,28 @@ public:
     {
     }
 
-    static void render_tag(const char *tag, const char *value, string *s)
-    {
-        *s += StringPrintf("<%s>%s</%s>\n", tag, value, tag);
-    }
-
-    static const char *alt(const char *opt, const char *def)
+    static constexpr const char *alt(const char *opt, const char *def)
     {
-        if (opt)
-            return opt;
-        return def;
+        return opt ? opt : def;
     }
 
-    template <typename... Args> void render_cdi(string *s, Args... args) const
+    /// Renders the identification tag. When rendering at compile time,
+    /// SNIP_STATIC_DATA has to be defined as constexpr (unless all four
+    /// values are overridden in the options).
+    template <class W, typename... Args>
+    CDI_CONSTEXPR void render_cdi(W *s, Args... args) const
     {
         IdentificationConfigOptions opts(args...);
-        extern const SimpleNodeStaticValues SNIP_STATIC_DATA;
-        *s += "<identification>\n";
-        render_tag("manufacturer",
-            alt(opts.manufacturer(), SNIP_STATIC_DATA.manufacturer_name), s);
-        render_tag("model", alt(opts.model(), SNIP_STATIC_DATA.model_name), s);
-        render_tag("hardwareVersion",
-            alt(opts.hardware_version(), SNIP_STATIC_DATA.hardware_version), s);
-        render_tag("softwareVersion",
-            alt(opts.software_version(), SNIP_STATIC_DATA.software_version), s);
-        *s += "</identification>\n";
+        s->append("<identification>\n");
+        cdi_append_element(s, "manufacturer",
+            alt(opts.manufacturer(), SNIP_STATIC_DATA.manufacturer_name));
+        cdi_append_element(
+            s, "model", alt(opts.model(), SNIP_STATIC_DATA.model_name));
+        cdi_append_element(s, "hardwareVersion",
+            alt(opts.hardware_version(), SNIP_STATIC_DATA.hardware_version));
+        cdi_append_element(s, "softwareVersion",
+            alt(opts.software_version(), SNIP_STATIC_DATA.software_version));
+        s->append("</identification>\n");
     }
 };
 
@@ -500,7 +579,7 @@ public:
 
     typedef AtomConfigOptions OptionsType;
 
-    void render_cdi(string *s) const
+    template <class W> CDI_CONSTEXPR void render_cdi(W *s) const
     {
         s->append("<acdi/>\n");
     }
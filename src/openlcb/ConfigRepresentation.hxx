@@ -154,26 +154,28 @@ public:
             return openlcb::NoopGroupEntry(                                    \
                 entry(openlcb::EntryMarker<LINE - 1>()).end_offset());         \
         }                                                                      \
-        template <int LINE>                                                    \
-        static void render_content_cdi(                                        \
-            const openlcb::EntryMarker<LINE> &, std::string *s)                \
+        template <int LINE, class W>                                           \
+        static CDI_CONSTEXPR void render_content_cdi(                          \
+            const openlcb::EntryMarker<LINE> &, W *s)                          \
         {                                                                      \
             render_content_cdi(openlcb::EntryMarker<LINE - 1>(), s);           \
         }                                                                      \
-        static void render_content_cdi(                                        \
-            const openlcb::EntryMarker<START_LINE> &, std::string *s)          \
+        template <class W>                                                     \
+        static CDI_CONSTEXPR void render_content_cdi(                          \
+            const openlcb::EntryMarker<START_LINE> &, W *s)                    \
         {                                                                      \
         }                                                                      \
-        template <int LINE>                                                    \
-        void __attribute__((always_inline))                                    \
-            recursive_handle_events(const openlcb::EntryMarker<LINE> &,        \
-                const openlcb::EventOffsetCallback &fn)                        \
+        template <int LINE, class F>                                           \
+        CDI_CONSTEXPR void __attribute__((always_inline))                      \
+            recursive_handle_events(                                           \
+                const openlcb::EntryMarker<LINE> &, F &&fn) const              \
         {                                                                      \
             recursive_handle_events(openlcb::EntryMarker<LINE - 1>(), fn);     \
         }                                                                      \
-        void __attribute__((always_inline))                                    \
-            recursive_handle_events(const openlcb::EntryMarker<START_LINE> &,  \
-                const openlcb::EventOffsetCallback &fn)                        \
+        template <class F>                                                     \
+        CDI_CONSTEXPR void __attribute__((always_inline))                      \
+            recursive_handle_events(                                           \
+                const openlcb::EntryMarker<START_LINE> &, F &&fn) const        \
         {                                                                      \
         }                                                                      \
                                                                                \
@@ -205,15 +207,17 @@ public:
     {                                                                          \
         return decltype(TYPE::config_renderer())::OptionsType(__VA_ARGS__);    \
     }                                                                          \
-    static void render_content_cdi(                                            \
-        const openlcb::EntryMarker<LINE> &, std::string *s)                    \
+    template <class W>                                                         \
+    static CDI_CONSTEXPR void render_content_cdi(                              \
+        const openlcb::EntryMarker<LINE> &, W *s)                              \
     {                                                                          \
         render_content_cdi(openlcb::EntryMarker<LINE - 1>(), s);               \
         TYPE::config_renderer().render_cdi(s, ##__VA_ARGS__);                  \
     }                                                                          \
-    void __attribute__((always_inline))                                        \
+    template <class F>                                                         \
+    CDI_CONSTEXPR void __attribute__((always_inline))                          \
         recursive_handle_events(const openlcb::EntryMarker<LINE> &e,           \
-            const openlcb::EventOffsetCallback &fn)                            \
+            F &&fn) const                                                      \
     {                                                                          \
         recursive_handle_events(openlcb::EntryMarker<LINE - 1>(), fn);         \
         entry(e).handle_events(fn);                                            \
@@ -240,12 +244,14 @@ public:
         return group_opts().fixed_size() -                                     \
             (entry(openlcb::EntryMarker<LINE>()).end_offset() - offset());     \
     }                                                                          \
-    static void render_content_cdi(std::string *s)                             \
+    template <class W>                                                         \
+    static CDI_CONSTEXPR void render_content_cdi(W *s)                         \
     {                                                                          \
-        return render_content_cdi(openlcb::EntryMarker<LINE>(), s);            \
+        render_content_cdi(openlcb::EntryMarker<LINE>(), s);                   \
     }                                                                          \
-    void __attribute__((always_inline))                                        \
-        handle_events(const openlcb::EventOffsetCallback &fn)                  \
+    template <class F>                                                         \
+    CDI_CONSTEXPR void __attribute__((always_inline)) handle_events(F &&fn)    \
+        const                                                                  \
     {                                                                          \
         recursive_handle_events(openlcb::EntryMarker<LINE>(), fn);             \
     }                                                                          \
@@ -316,11 +322,11 @@ public:
         return GroupConfigRenderer<Group>(N, Group(0));
     }
 
-    void handle_events(const EventOffsetCallback &fn)
+    template <class F> CDI_CONSTEXPR void handle_events(F &&fn) const
     {
         for (unsigned i = 0; i < N; ++i)
         {
-            entry(i).handle_events(fn);
+            Group(offset_ + (i * Group::size())).handle_events(fn);
         }
     }
 };
@@ -36,6 +36,10 @@
 
 #include "openlcb/ConfigUpdateFlow.hxx"
 #include <fcntl.h>
+#include <limits.h>
+#include <algorithm>
+
+#include "nmranet_config.h"
 
 namespace openlcb
 {
@@ -57,8 +61,7 @@ int ConfigUpdateFlow::open_file(const char *path)
 
 void ConfigUpdateFlow::init_flow()
 {
-    trigger_update();
-    isInitialLoad_ = 1;
+    start_update(true, true);
 }
 
 void ConfigUpdateFlow::factory_reset()
@@ -68,6 +71,129 @@ void ConfigUpdateFlow::factory_reset()
     }
 }
 
+void ConfigUpdateFlow::add_range(
+    Range *ranges, unsigned *count, unsigned begin, unsigned end)
+{
+    unsigned i = 0;
+    while (i < *count)
+    {
+        if (begin <= ranges[i].end && ranges[i].begin <= end)
+        {
+            begin = std::min(begin, ranges[i].begin);
+            end = std::max(end, ranges[i].end);
+            ranges[i] = ranges[--*count];
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    if (*count < MAX_DIRTY)
+    {
+        ranges[(*count)++] = {begin, end};
+        return;
+    }
+    // No room: widens the closest range to include the new one. This may
+    // call some listeners unnecessarily, but never misses one.
+    unsigned best = 0;
+    unsigned best_gap = UINT_MAX;
+    for (i = 0; i < *count; ++i)
+    {
+        unsigned gap = ranges[i].begin > end ? ranges[i].begin - end
+                                             : begin - ranges[i].end;
+        if (gap < best_gap)
+        {
+            best_gap = gap;
+            best = i;
+        }
+    }
+    ranges[best].begin = std::min(begin, ranges[best].begin);
+    ranges[best].end = std::max(end, ranges[best].end);
+}
+
+bool ConfigUpdateFlow::needs_update(ConfigUpdateListener *l)
+{
+    if (refreshAll_)
+    {
+        return true;
+    }
+    unsigned ofs, size;
+    if (!l->config_extent(&ofs, &size))
+    {
+        return true;
+    }
+    for (unsigned i = 0; i < numActive_; ++i)
+    {
+        if (ofs < active_[i].end && active_[i].begin < ofs + size)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ConfigUpdateFlow::load_cache(ConfigUpdateListener *l)
+{
+    unsigned ofs = 0;
+    unsigned size = 0;
+    bool has_extent = l->config_extent(&ofs, &size);
+    if (cache_ && (!has_extent || cache_->covers(ofs, size)))
+    {
+        return;
+    }
+    if (!cache_)
+    {
+        // Where possible, we snapshot the whole file by mapping it.
+        cache_.reset(noMapping_ ? new ConfigReadCache(fd_, 0, 0)
+                                : new ConfigReadCache(fd_));
+        if (cache_->size())
+        {
+            return;
+        }
+        // Computes the range needed by the remaining listeners.
+        AtomicHolder h(this);
+        rangeNeeded_.begin = UINT_MAX;
+        rangeNeeded_.end = 0;
+        for (auto it = nextRefresh_; it != listeners_.end(); ++it)
+        {
+            unsigned o, s;
+            if (needs_update(it.operator->()) && it->config_extent(&o, &s))
+            {
+                rangeNeeded_.begin = std::min(rangeNeeded_.begin, o);
+                rangeNeeded_.end = std::max(rangeNeeded_.end, o + s);
+            }
+        }
+    }
+    unsigned max_size = config_config_update_cache_size();
+    if (!has_extent || size > max_size)
+    {
+        return;
+    }
+    unsigned begin = rangeNeeded_.begin;
+    unsigned end = rangeNeeded_.end;
+    if (end - begin > max_size)
+    {
+        // Does not fit in RAM at once. Reads a window starting at this
+        // listener, towards where the listeners have been progressing.
+        if (cache_->size() && ofs < cache_->offset())
+        {
+            end = ofs + size;
+            if (end - begin > max_size)
+            {
+                begin = end - max_size;
+            }
+        }
+        else
+        {
+            begin = ofs;
+            end = std::min(end, begin + max_size);
+        }
+    }
+    // Frees the old window before allocating the new one.
+    cache_.reset();
+    cache_.reset(new ConfigReadCache(fd_, begin, end - begin));
+}
+
 extern const char *const CONFIG_FILENAME __attribute__((weak)) = nullptr;
 extern const size_t CONFIG_FILE_SIZE __attribute__((weak)) = 0;
 
@@ -37,9 +37,13 @@
 #ifndef _NMRANET_CONFIGUPDATEFLOW_HXX_
 #define _NMRANET_CONFIGUPDATEFLOW_HXX_
 
+#include <memory>
+
 #include "utils/ConfigUpdateListener.hxx"
 #include "utils/ConfigUpdateService.hxx"
+#include "openlcb/ConfigEntry.hxx"
 #include "openlcb/NodeInitializeFlow.hxx"
+#include "openlcb/EventHandler.hxx"
 #include "executor/StateFlow.hxx"
 
 #if !defined (__MACH__)
@@ -56,6 +60,14 @@ namespace openlcb
 /// to the registered ConfigUpdateListener descendants. This flow also handles
 /// any necessary action such as reboot or factory reset. This flow keeps the
 /// file descriptor for the config file that's currently open.
+///
+/// Updates can be delta-driven: ranges of the config file reported via
+/// mark_dirty() are collected, and trigger_dirty_update() calls only the
+/// listeners whose config_extent overlaps them. trigger_update() calls every
+/// listener. The listeners read the config from a
+/// snapshot (ConfigReadCache) taken once per update cycle: a mapping of the
+/// whole file where the OS supports it, otherwise a RAM copy of the range
+/// they need.
 class ConfigUpdateFlow : public StateFlowBase,
                          public ConfigUpdateService,
                          private Atomic
@@ -64,8 +76,11 @@ public:
     ConfigUpdateFlow(If *iface)
         : StateFlowBase(iface)
         , nextRefresh_(listeners_.begin())
+        , numDirty_(0)
+        , numActive_(0)
         , fd_(-1)
     {
+        noMapping_ = 0;
     }
 
     /// Must be called once before calling anything else. Returns the file
@@ -81,17 +96,36 @@ public:
         fd_ = fd;
     }
 
+    /// Makes the flow use RAM copies instead of mapping the config file, like
+    /// on an MCU.
+    void TEST_disable_mapping()
+    {
+        noMapping_ = 1;
+    }
+
     void trigger_update() override
+    {
+        start_update(false, true);
+    }
+
+    void trigger_dirty_update() override
+    {
+        start_update(false, false);
+    }
+
+    void mark_dirty(unsigned offset, unsigned size) override
     {
         AtomicHolder h(this);
-        nextRefresh_ = listeners_.begin();
-        isInitialLoad_ = 0;
-        needsReboot_ = 0;
-        needsReInit_ = 0;
-        if (is_state(exit().next_state()))
-        {
-            start_flow(STATE(call_next_listener));
-        }
+        add_range(dirty_, &numDirty_, offset, offset + size);
+        // The file has changed under the cache.
+        cacheStale_ = 1;
+        ++writeCount_;
+    }
+
+    unsigned write_count() override
+    {
+        AtomicHolder h(this);
+        return writeCount_;
     }
 
     void register_update_listener(ConfigUpdateListener *listener) OVERRIDE
@@ -120,8 +154,23 @@ private:
     Action call_next_listener()
     {
         ConfigUpdateListener *l = nullptr;
+        bool drop_cache;
+        {
+            AtomicHolder h(this);
+            drop_cache = cacheStale_;
+            cacheStale_ = 0;
+        }
+        if (drop_cache)
+        {
+            cache_.reset();
+        }
         {
             AtomicHolder h(this);
+            while (nextRefresh_ != listeners_.end() &&
+                !needs_update(nextRefresh_.operator->()))
+            {
+                ++nextRefresh_;
+            }
             if (nextRefresh_ == listeners_.end())
             {
                 /// TODO(balazs.racz) apply the changes reported.
@@ -134,17 +183,31 @@ private:
                     // Takes over ownership of itself, will delete when done.
                     new ReinitAllNodes(static_cast<If*>(service()));
                 }
-                return exit();
+                if (eventBatch_)
+                {
+                    EventRegistry::instance()->commit_batch();
+                }
             }
-            l = nextRefresh_.operator->();
+            else
+            {
+                l = nextRefresh_.operator->();
+            }
+        }
+        if (!l)
+        {
+            cache_.reset();
+            return exit();
         }
         if (fd_ < 0)
         {
             DIE("CONFIG_FILENAME not specified, or init() was not called, but "
                 "there are configuration listeners.");
         }
+        load_cache(l);
+        cache_->install();
         ConfigUpdateListener::UpdateAction action =
             l->apply_configuration(fd_, isInitialLoad_, n_.reset(this));
+        cache_->uninstall();
         switch (action)
         {
             case ConfigUpdateListener::UPDATED:
@@ -171,6 +234,81 @@ private:
         return wait();
     }
 
+    /// Starts (or restarts) an update cycle.
+    /// @param initial_load is true for the first load after startup.
+    /// @param all is true if every listener has to be called, false if only
+    /// the ones overlapping the dirty ranges.
+    void start_update(bool initial_load, bool all)
+    {
+        AtomicHolder h(this);
+        bool idle = is_state(exit().next_state());
+        if (idle)
+        {
+            numActive_ = 0;
+            refreshAll_ = 0;
+        }
+        // If nobody told us what changed, everything needs to be refreshed.
+        if (!numDirty_ || all)
+        {
+            refreshAll_ = 1;
+        }
+        for (unsigned i = 0; i < numDirty_; ++i)
+        {
+            add_range(active_, &numActive_, dirty_[i].begin, dirty_[i].end);
+        }
+        numDirty_ = 0;
+        cacheStale_ = 1;
+        nextRefresh_ = listeners_.begin();
+        isInitialLoad_ = initial_load ? 1 : 0;
+        needsReboot_ = 0;
+        needsReInit_ = 0;
+        if (idle)
+        {
+            // Listeners typically re-register their event handlers; lets
+            // the registry apply these changes in bulk.
+            eventBatch_ = EventRegistry::exists() ? 1 : 0;
+            if (eventBatch_)
+            {
+                EventRegistry::instance()->begin_batch();
+            }
+            start_flow(STATE(call_next_listener));
+        }
+    }
+
+    /// A range of bytes in the config file.
+    struct Range
+    {
+        /// First byte.
+        unsigned begin;
+        /// One past the last byte.
+        unsigned end;
+    };
+
+    /// How many disjoint dirty ranges we keep track of. More ranges get merged
+    /// with the nearest one.
+    static constexpr unsigned MAX_DIRTY = 4;
+
+    /// Adds a range to a set of ranges, merging it with overlapping or
+    /// adjacent ones.
+    /// @param ranges is the set of ranges, with room for MAX_DIRTY entries.
+    /// @param count is the number of entries in ranges; will be updated.
+    /// @param begin is the first byte of the new range.
+    /// @param end is one past the last byte of the new range.
+    static void add_range(
+        Range *ranges, unsigned *count, unsigned begin, unsigned end);
+
+    /// @return true if the current update cycle has to call this
+    /// listener. Must be called with the lock held.
+    bool needs_update(ConfigUpdateListener *l);
+
+    /// Makes sure cache_ has the part of the config file that a listener
+    /// needs. Maps the entire file if possible, otherwise reads the range
+    /// needed by the remaining listeners of this update cycle into RAM, or if
+    /// that is too big, a window of it starting at this listener. After the
+    /// call cache_ is not null.
+    /// @param l is the listener about to be called.
+    void load_cache(ConfigUpdateListener *l);
+
     typedef TypedQueue<ConfigUpdateListener> queue_type;
     /// All registered update listeners. Protected by Atomic *this.
     queue_type listeners_;
@@ -180,8 +318,32 @@ private:
     unsigned isInitialLoad_ : 1;
     unsigned needsReboot_ : 1;
     unsigned needsReInit_ : 1;
+    /// 1 if we opened a batch on the event registry.
+    unsigned eventBatch_ : 1;
+    /// 1 if this update cycle has to call every listener.
+    unsigned refreshAll_ : 1;
+    /// 1 if cache_ has to be thrown away before the next listener is called.
+    unsigned cacheStale_ : 1;
+    /// 1 if we must not try to map the config file.
+    unsigned noMapping_ : 1;
+    /// Ranges modified since the last update was triggered.
+    Range dirty_[MAX_DIRTY];
+    /// Number of entries in dirty_.
+    unsigned numDirty_;
+    /// Ranges the current update cycle is applying.
+    Range active_[MAX_DIRTY];
+    /// Number of entries in active_.
+    unsigned numActive_;
+    /// How many times mark_dirty() was called.
+    unsigned writeCount_{0};
     int fd_;
     BarrierNotifiable n_;
+    /// Part of the config file the listeners of the current update cycle
+    /// read. Computed when the cache is first loaded.
+    Range rangeNeeded_;
+    /// Snapshot of the config file for the listeners of the current update
+    /// cycle.
+    std::unique_ptr<ConfigReadCache> cache_;
 };
 
 } // namespace openlcb
@@ -134,6 +134,13 @@ public:
     {
     }
 
+    bool config_extent(unsigned *offset, unsigned *size) OVERRIDE
+    {
+        *offset = cfg_.offset();
+        *size = cfg_.size();
+        return true;
+    }
+
 private:
     Impl impl_;
     BitEventConsumer consumer_;
@@ -196,6 +203,13 @@ public:
     {
     }
 
+    bool config_extent(unsigned *offset, unsigned *size) OVERRIDE
+    {
+        *offset = cfg_.offset();
+        *size = cfg_.size();
+        return true;
+    }
+
 private:
     /// Registers the event handler with the global event registry.
     void do_register()
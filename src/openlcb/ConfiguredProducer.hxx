@@ -140,6 +140,13 @@ public:
     {
     }
 
+    bool config_extent(unsigned *offset, unsigned *size) OVERRIDE
+    {
+        *offset = cfg_.offset();
+        *size = cfg_.size();
+        return true;
+    }
+
     Polling *polling()
     {
         return &producer_;
@@ -0,0 +1,182 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file DenseNodes.cxx
+ *
+ * Compact storage for large numbers of virtual nodes with consecutive node
+ * IDs.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include "openlcb/DenseNodes.hxx"
+
+#include "openlcb/If.hxx"
+#include "openlcb/NodeInitializeFlow.hxx"
+
+namespace openlcb
+{
+
+/// Sends the nodes waiting for activation to the InitializeFlow, one at a
+/// time.
+class DenseNodeSet::ActivationFlow : public StateFlowBase
+{
+public:
+    ActivationFlow(DenseNodeSet *set)
+        : StateFlowBase(set->iface_)
+        , set_(set)
+    {
+    }
+
+    /// Starts processing the pending activations if not yet running.
+    void start()
+    {
+        if (is_terminated())
+        {
+            start_flow(STATE(find_next));
+        }
+    }
+
+    /// @return true if there is no activation in progress.
+    bool is_idle()
+    {
+        return is_terminated();
+    }
+
+private:
+    Action find_next()
+    {
+        if (!set_->numPending_)
+        {
+            return exit();
+        }
+        while (!set_->pending_[next_])
+        {
+            if (++next_ >= set_->count_)
+            {
+                next_ = 0;
+            }
+        }
+        set_->pending_[next_] = false;
+        --set_->numPending_;
+        if (set_->initialized_[next_])
+        {
+            return again();
+        }
+        return allocate_and_call(tgt(), STATE(send_request));
+    }
+
+    Action send_request()
+    {
+        auto *b = get_allocation_result(tgt());
+        b->data()->node = set_->node(next_);
+        b->set_done(bn_.reset(this));
+        tgt()->send(b);
+        return wait_and_call(STATE(find_next));
+    }
+
+    InitializeFlow *tgt()
+    {
+        return Singleton<InitializeFlow>::instance();
+    }
+
+    /// Set whose nodes we are activating.
+    DenseNodeSet *set_;
+    /// Index of the node being activated.
+    unsigned next_{0};
+    /// Notified when the InitializeFlow is done with a node.
+    BarrierNotifiable bn_;
+};
+
+DenseNodeSet::DenseNodeSet(If *iface, NodeID base, unsigned count)
+    : iface_(iface)
+    , base_(base)
+    , count_(count)
+    , nodes_(new DenseNode[count])
+    , initialized_(count, false)
+    , pending_(count, false)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        nodes_[i].set_ = this;
+    }
+    iface_->add_local_node_set(this);
+}
+
+DenseNodeSet::~DenseNodeSet()
+{
+    HASSERT(!activationFlow_ || activationFlow_->is_idle());
+    for (unsigned i = 0; i < count_; ++i)
+    {
+        // Releases the alias if the node has one.
+        iface_->delete_local_node(node(i));
+    }
+    iface_->remove_local_node_set(this);
+}
+
+void DenseNodeSet::activate(unsigned index)
+{
+    HASSERT(index < count_);
+    if (pending_[index] || initialized_[index])
+    {
+        return;
+    }
+    pending_[index] = true;
+    ++numPending_;
+    if (!activationFlow_)
+    {
+        activationFlow_.reset(new ActivationFlow(this));
+    }
+    activationFlow_->start();
+}
+
+void DenseNodeSet::activate_all()
+{
+    for (unsigned i = 0; i < count_; ++i)
+    {
+        activate(i);
+    }
+}
+
+void DenseNodeSet::set_initialized(unsigned index, bool value)
+{
+    if (initialized_[index] == value)
+    {
+        return;
+    }
+    initialized_[index] = value;
+    if (value)
+    {
+        ++numInitialized_;
+    }
+    else
+    {
+        --numInitialized_;
+    }
+}
+
+} // namespace openlcb
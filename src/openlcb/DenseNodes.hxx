@@ -0,0 +1,198 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file DenseNodes.hxx
+ *
+ * Compact storage for large numbers of virtual nodes with consecutive node
+ * IDs.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _OPENLCB_DENSENODES_HXX_
+#define _OPENLCB_DENSENODES_HXX_
+
+#include <memory>
+#include <vector>
+
+#include "openlcb/Node.hxx"
+
+namespace openlcb
+{
+
+class If;
+
+/// A block of virtual nodes with consecutive node IDs, for simulations and
+/// large command stations that need thousands of virtual nodes.
+///
+/// Compared to a DefaultNode per ID, a node here takes two pointers and a few
+/// bits of state; the nodes are not entered into the interface's local node
+/// map, but the interface consults the set when looking up a node ID. The
+/// nodes have no node-specific protocol handlers; they are served by the
+/// handlers registered for all nodes (with a nullptr node).
+///
+/// Nodes start in the uninitialized state, thus they do not send any traffic
+/// and do not allocate a CAN alias until they are activated. Activation runs
+/// the InitializeFlow for one node at a time.
+class DenseNodeSet
+{
+public:
+    /// Creates the nodes and registers them with the interface. Must be called
+    /// on the interface's executor (or before it is started).
+    ///
+    /// @param iface is the interface the nodes live on.
+    /// @param base is the node ID of the first node.
+    /// @param count is the number of nodes.
+    DenseNodeSet(If *iface, NodeID base, unsigned count);
+
+    /// Removes the nodes from the interface and releases their aliases. There
+    /// must be no activation in progress.
+    ~DenseNodeSet();
+
+    /// @return the node ID of the first node.
+    NodeID base()
+    {
+        return base_;
+    }
+
+    /// @return the number of nodes in the set.
+    unsigned size()
+    {
+        return count_;
+    }
+
+    /// @return the node with the given ID, or nullptr if the ID is not in
+    /// this set.
+    /// @param id is the node ID to look up.
+    Node *lookup(NodeID id)
+    {
+        NodeID ofs = id - base_;
+        return ofs < count_ ? &nodes_[ofs] : nullptr;
+    }
+
+    /// @return a node by its index in the set.
+    /// @param index is between 0 and size() - 1.
+    Node *node(unsigned index)
+    {
+        return &nodes_[index];
+    }
+
+    /// Asks for a node to be initialized on the bus (Initialization Complete
+    /// and identifying its events). Activations are queued and performed one
+    /// node at a time. Must be called on the interface's executor.
+    ///
+    /// @param index is the node to activate.
+    void activate(unsigned index);
+
+    /// Activates all nodes of the set.
+    void activate_all();
+
+    /// @return the number of nodes that are in the initialized state.
+    unsigned num_initialized()
+    {
+        return numInitialized_;
+    }
+
+    /// @return the number of nodes waiting for activation.
+    unsigned num_pending()
+    {
+        return numPending_;
+    }
+
+private:
+    /// One virtual node of the set. All the state is in the set.
+    class DenseNode : public Node
+    {
+    public:
+        NodeID node_id() override
+        {
+            return set_->base_ + index();
+        }
+
+        If *iface() override
+        {
+            return set_->iface_;
+        }
+
+        bool is_initialized() override
+        {
+            return set_->initialized_[index()];
+        }
+
+        void set_initialized() override
+        {
+            set_->set_initialized(index(), true);
+        }
+
+        void clear_initialized() override
+        {
+            set_->set_initialized(index(), false);
+        }
+
+    private:
+        friend class DenseNodeSet;
+
+        /// @return the index of this node in the set.
+        unsigned index()
+        {
+            return this - set_->nodes_.get();
+        }
+
+        /// The set this node belongs to.
+        DenseNodeSet *set_;
+    };
+
+    class ActivationFlow;
+
+    /// Updates the initialized state of a node.
+    /// @param index is the node.
+    /// @param value is the new state.
+    void set_initialized(unsigned index, bool value);
+
+    /// Interface the nodes are registered with.
+    If *iface_;
+    /// Node ID of nodes_[0].
+    NodeID base_;
+    /// Number of nodes.
+    unsigned count_;
+    /// Number of nodes in the initialized state.
+    unsigned numInitialized_{0};
+    /// Number of nodes with pending_ set.
+    unsigned numPending_{0};
+    /// Node objects.
+    std::unique_ptr<DenseNode[]> nodes_;
+    /// One bit per node: is the node initialized.
+    std::vector<bool> initialized_;
+    /// One bit per node: is the node waiting for activation.
+    std::vector<bool> pending_;
+    /// Runs the activations; created upon first use.
+    std::unique_ptr<ActivationFlow> activationFlow_;
+};
+
+} // namespace openlcb
+
+#endif // _OPENLCB_DENSENODES_HXX_
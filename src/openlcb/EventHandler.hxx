@@ -241,6 +241,12 @@ public:
         return instance_;
     }
 
+    /// @return true if an event registry was already created.
+    static bool exists()
+    {
+        return instance_ != nullptr;
+    }
+
     /** Computes the alignment mask for registering an event range. Updates the
      * event by rounding and returns the mask value to be sent to the
      * register_handler function.
@@ -259,9 +265,24 @@ public:
     /// Creates a new event iterator. Caller takes ownership of object.
     virtual EventIterator *create_iterator() = 0;
 
+    /// Starts a batch of register_handler and unregister_handler calls, such
+    /// as when all config listeners re-register their events after a config
+    /// reload. Implementations may defer updating their lookup structures
+    /// until the batch is committed; lookups made in the middle of a batch
+    /// still see every change made before them. Batches may be nested.
+    virtual void begin_batch()
+    {
+    }
+
+    /// Ends a batch of registration calls started by begin_batch().
+    virtual void commit_batch()
+    {
+    }
+
     /// Returns a monotonically increasing number that will change every time
     /// the set of registered event handlers change. Whenever this number
-    /// changes, the iterators are invalidated and must be cleared.
+    /// changes, the iterators are invalidated and must be resumed (see
+    /// EventIterator::resume_iteration).
     unsigned get_epoch()
     {
         return dirtyCounter_;
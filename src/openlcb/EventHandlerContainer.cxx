@@ -34,6 +34,8 @@
 
 #include "openlcb/EventHandlerContainer.hxx"
 
+#include <limits.h>
+
 namespace openlcb
 {
 
@@ -42,25 +44,109 @@ void TreeEventHandlers::register_handler(const EventRegistryEntry &entry,
 {
     AtomicHolder h(this);
     set_dirty();
-    handlers_[mask].insert(EventRegistryEntry(entry));
+    if (!pendingRemoval_.size())
+    {
+        handlers_[mask].insert(EventRegistryEntry(entry));
+    }
+    else
+    {
+        // Iterators walk the pending entries together with the ones of the
+        // same mask in handlers_.
+        handlers_[mask];
+        pendingAdd_[mask].insert({entry, ++pendingAddCount_});
+    }
 }
 
 void TreeEventHandlers::unregister_handler(EventHandler *handler)
 {
     AtomicHolder h(this);
     set_dirty();
-    bool found = false;
-    for (auto r = handlers_.begin(); r != handlers_.end(); ++r) {
-        for (auto it = r->second.begin(); it != r->second.end(); ++it) {
-            if (it->handler == handler)
+    pendingRemoval_.insert({handler, pendingAddCount_, false});
+    if (!batchDepth_)
+    {
+        flush_pending();
+    }
+}
+
+void TreeEventHandlers::begin_batch()
+{
+    AtomicHolder h(this);
+    ++batchDepth_;
+}
+
+void TreeEventHandlers::commit_batch()
+{
+    AtomicHolder h(this);
+    HASSERT(batchDepth_ > 0);
+    if (--batchDepth_ == 0)
+    {
+        flush_pending();
+    }
+}
+
+bool TreeEventHandlers::is_removed(EventHandler *handler, unsigned add_index)
+{
+    for (auto it = pendingRemoval_.lower_bound(handler);
+         it != pendingRemoval_.end() && it->handler == handler; ++it)
+    {
+        if (it->addCount >= add_index)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TreeEventHandlers::flush_pending()
+{
+    if (!pendingRemoval_.size())
+    {
+        // pendingAdd_ is only used when there are removals pending.
+        return;
+    }
+    for (auto &r : handlers_)
+    {
+        r.second.remove_if([this](const EventRegistryEntry &e) {
+            auto it = pendingRemoval_.lower_bound(e.handler);
+            if (it == pendingRemoval_.end() || it->handler != e.handler)
+            {
+                return false;
+            }
+            it->found = true;
+            return true;
+        });
+    }
+    for (auto &m : pendingAdd_)
+    {
+        for (PendingAdd &p : m.second)
+        {
+            if (is_removed(p.entry.handler, p.addIndex))
             {
-                r->second.erase(it);
-                found = true;
+                pendingRemoval_.lower_bound(p.entry.handler)->found = true;
+                continue;
             }
+            handlers_[m.first].insert(std::move(p.entry));
         }
     }
-    if (found) return;
-    DIE("tried to unregister a handler that was not registered");
+    // Handlers unregistered multiple times are marked found on their first
+    // pending removal only.
+    for (auto it = pendingRemoval_.begin(); it != pendingRemoval_.end();)
+    {
+        EventHandler *handler = it->handler;
+        bool found = false;
+        for (; it != pendingRemoval_.end() && it->handler == handler; ++it)
+        {
+            found |= it->found;
+        }
+        if (!found)
+        {
+            DIE("tried to unregister a handler that was not registered");
+        }
+    }
+    // Releases the memory; batches are rare.
+    pendingRemoval_.clear();
+    pendingAdd_.clear();
+    pendingAddCount_ = 0;
 }
 
 /// Class representing the iteration state on the binary tree-based event
@@ -70,6 +156,7 @@ class TreeEventHandlers::Iterator : public EventIterator
 public:
     Iterator(TreeEventHandlers *parent)
         : parent_(parent)
+        , lastEntry_(nullptr, 0)
     {
         AtomicHolder h(parent_);
         parent->handlers_[0];
@@ -81,21 +168,37 @@ public:
         AtomicHolder h(parent_);
         while (maskIterator_ != parent_->handlers_.end())
         {
-            if (it_ == end_)
+            while (it_ != end_ && parent_->pendingRemoval_.size() &&
+                parent_->is_removed(it_->handler, 0))
+            {
+                ++it_;
+            }
+            EventRegistryEntry *e = it_ == end_ ? nullptr : &*it_;
+            // Entries registered in the middle of a batch are returned in
+            // the order they will have in handlers_ after the flush, so that
+            // resume_iteration can find the position after a flush too.
+            EventRegistryEntry *p = next_pending();
+            if (p && (!e || cmpop()(*p, *e)))
+            {
+                e = p;
+            }
+            else if (e)
+            {
+                ++it_;
+            }
+            else
             {
                 maskIterator_++;
+                hasLast_ = false;
                 if (maskIterator_ != parent_->handlers_.end())
                 {
                     setup_current_mask();
                 }
                 continue;
             }
-            else
-            {
-                EventRegistryEntry *e = &*it_;
-                it_++;
-                return e;
-            }
+            lastEntry_ = *e;
+            hasLast_ = true;
+            return e;
         }
         return nullptr;
     }
@@ -104,16 +207,85 @@ public:
     {
         AtomicHolder h(parent_);
         maskIterator_ = parent_->handlers_.end();
+        hasLast_ = false;
     }
     void init_iteration(EventReport *r) OVERRIDE
     {
         AtomicHolder h(parent_);
         currentReport_ = r;
         maskIterator_ = parent_->handlers_.begin();
+        hasLast_ = false;
         setup_current_mask();
     }
 
+    void resume_iteration(EventReport *r) OVERRIDE
+    {
+        AtomicHolder h(parent_);
+        currentReport_ = r;
+        if (maskIterator_ != parent_->handlers_.end())
+        {
+            // The entries of the current mask may have been moved, or a
+            // batch flush may have moved the pending entries into
+            // handlers_. Seeks right after the last returned entry; the
+            // entries are totally ordered, so nothing gets returned twice.
+            setup_current_mask();
+            if (hasLast_)
+            {
+                it_ = std::max(
+                    it_, maskIterator_->second.upper_bound(lastEntry_));
+            }
+        }
+    }
+
 private:
+    /// @return true if an entry registered with a given mask should be
+    /// returned for the current report. Same as the range computed by
+    /// setup_current_mask.
+    bool matches(unsigned mask_log, uint64_t event)
+    {
+        if (mask_log == 64)
+        {
+            return true;
+        }
+        uint64_t current_mask = (1ULL << mask_log) - 1;
+        return event >= (currentReport_->event & (~current_mask)) &&
+            event <= currentReport_->event + currentReport_->mask;
+    }
+
+    /// @return the first entry of the current mask registered in the middle
+    /// of a batch that matches the current report and comes after
+    /// lastEntry_, or nullptr if there is none.
+    EventRegistryEntry *next_pending()
+    {
+        auto m = parent_->pendingAdd_.find(maskIterator_->first);
+        if (m == parent_->pendingAdd_.end())
+        {
+            return nullptr;
+        }
+        unsigned mask_log = m->first;
+        auto &pending = m->second;
+        auto it = pending.begin();
+        if (hasLast_)
+        {
+            it = pending.upper_bound(lastEntry_);
+        }
+        else if (mask_log != 64)
+        {
+            uint64_t current_mask = (1ULL << mask_log) - 1;
+            it = pending.lower_bound(currentReport_->event & (~current_mask));
+        }
+        // Everything from here on is past the start of the range, so the
+        // first entry that does not match is past its end.
+        for (; it != pending.end() && matches(mask_log, it->entry.event); ++it)
+        {
+            if (!parent_->is_removed(it->entry.handler, it->addIndex))
+            {
+                return &it->entry;
+            }
+        }
+        return nullptr;
+    }
+
     void setup_current_mask()
     {
         if (maskIterator_->first == 64)
@@ -135,6 +307,10 @@ private:
     MaskLookupMap::iterator maskIterator_;
     OneMaskMap::iterator it_;
     OneMaskMap::iterator end_;
+    /// Copy of the entry that next_entry() returned last.
+    EventRegistryEntry lastEntry_;
+    /// true if lastEntry_ is in the current mask's set.
+    bool hasLast_{false};
 };
 
 EventIterator *TreeEventHandlers::create_iterator()
@@ -79,6 +79,19 @@ public:
 
     /** Stops iteration and resets iteration variables. */
     virtual void clear_iteration() = 0;
+
+    /** Continues an iteration after the set of registered handlers has
+     * changed (i.e. the registry epoch moved). Entries that were already
+     * returned before the change will not be returned again. The default
+     * implementation restarts the iteration, which may return the same
+     * entries twice.
+     *
+     * @param event is the event report the iteration was started with. */
+    virtual void resume_iteration(EventReport *event)
+    {
+        clear_iteration();
+        init_iteration(event);
+    }
 };
 
 /// EventIterator that produces every single entry in a given container (which
@@ -159,11 +172,18 @@ public:
     void register_handler(const EventRegistryEntry &entry,
                           unsigned mask) OVERRIDE;
     void unregister_handler(EventHandler* handler) OVERRIDE;
+    void begin_batch() OVERRIDE;
+    void commit_batch() OVERRIDE;
 
 private:
     class Iterator;
     friend class Iterator;
 
+    /// Applies the registration changes deferred by a batch. Removing the
+    /// handlers is a single linear pass over the registry, no matter how many
+    /// handlers were unregistered. Must be called with the lock held.
+    void flush_pending();
+
     /// Comparison operator for event registry entries.
     struct cmpop
     {
@@ -177,7 +197,17 @@ private:
         }
         bool operator()(const EventRegistryEntry &a, const EventRegistryEntry &b)
         {
-            return a.event < b.event;
+            // Breaks ties so that iterators can find their position again
+            // after the registry has changed.
+            if (a.event != b.event)
+            {
+                return a.event < b.event;
+            }
+            if (a.handler != b.handler)
+            {
+                return a.handler < b.handler;
+            }
+            return a.user_arg < b.user_arg;
         }
     };
 
@@ -187,6 +217,81 @@ private:
      * bits wide the registration is (it is the mask value in the register
      * call).*/
     MaskLookupMap handlers_;
+
+    /// A handler that was unregistered during a batch.
+    struct PendingRemoval
+    {
+        EventHandler *handler;
+        /// Entries in pendingAdd_ with an addIndex up to this were registered
+        /// before the handler was unregistered, so they have to be removed
+        /// too.
+        unsigned addCount;
+        /// Set when we found at least one entry to remove.
+        bool found;
+    };
+
+    /// Comparison operator for pending removals.
+    struct cmpremoval
+    {
+        bool operator()(const PendingRemoval &d, EventHandler *k)
+        {
+            return d.handler < k;
+        }
+        bool operator()(EventHandler *k, const PendingRemoval &d)
+        {
+            return k < d.handler;
+        }
+        bool operator()(const PendingRemoval &a, const PendingRemoval &b)
+        {
+            return a.handler < b.handler;
+        }
+    };
+
+    /// Checks whether an entry is removed by the current batch.
+    /// @param handler is the handler of the entry.
+    /// @param add_index is 0 for entries in handlers_ and the addIndex for
+    /// the entries in pendingAdd_.
+    /// @return true if the entry must not be visible anymore.
+    bool is_removed(EventHandler *handler, unsigned add_index);
+
+    /// An entry registered in the middle of a batch.
+    struct PendingAdd
+    {
+        EventRegistryEntry entry;
+        /// How many entries were registered in the batch up to and including
+        /// this one.
+        unsigned addIndex;
+    };
+
+    /// Comparison operator for pending entries. Same order as cmpop.
+    struct cmppending
+    {
+        bool operator()(const PendingAdd &d, uint64_t k)
+        {
+            return d.entry.event < k;
+        }
+        bool operator()(const EventRegistryEntry &k, const PendingAdd &d)
+        {
+            return cmpop()(k, d.entry);
+        }
+        bool operator()(const PendingAdd &a, const PendingAdd &b)
+        {
+            return cmpop()(a.entry, b.entry);
+        }
+    };
+
+    /// Handlers unregistered in the current batch. Lookups in the middle of
+    /// a batch skip their entries instead of flushing the batch.
+    SortedListSet<PendingRemoval, cmpremoval> pendingRemoval_;
+    /// Entries registered after the first unregister_handler call of the
+    /// current batch, by mask. These must not be affected by the pending
+    /// removals that came before them, so they are kept aside until the batch
+    /// is flushed.
+    std::map<uint8_t, SortedListSet<PendingAdd, cmppending>> pendingAdd_;
+    /// Number of entries registered into pendingAdd_ in the current batch.
+    unsigned pendingAddCount_{0};
+    /// How many begin_batch calls are not yet committed.
+    unsigned batchDepth_{0};
 };
 
 }; /* namespace openlcb */
@@ -241,11 +241,11 @@ StateFlowBase::Action EventIteratorFlow::iterate_next()
 {
     if (eventRegistryEpoch_ != eventService_->impl()->registry->get_epoch())
     {
-        // Iterators are invalidated. We need to start over. This may cause
-        // duplicate delivery of the same events.
-        iterator_->clear_iteration();
+        // Iterators are invalidated. The iterator finds its place again;
+        // depending on the registry implementation this may start over and
+        // cause duplicate delivery of the same events.
         eventRegistryEpoch_ = eventService_->impl()->registry->get_epoch();
-        iterator_->init_iteration(&eventReport_);
+        iterator_->resume_iteration(&eventReport_);
     }
 
     EventRegistryEntry *entry = iterator_->next_entry();
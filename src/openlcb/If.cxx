@@ -152,4 +152,17 @@ If::If(ExecutorBase *executor, int local_nodes_count)
 {
 }
 
+void If::remove_local_node_set(DenseNodeSet *nodes)
+{
+    for (auto it = denseNodes_.begin(); it != denseNodes_.end(); ++it)
+    {
+        if (*it == nodes)
+        {
+            denseNodes_.erase(it);
+            return;
+        }
+    }
+    DIE("Removing an unknown DenseNodeSet.");
+}
+
 } // namespace openlcb
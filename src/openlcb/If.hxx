@@ -40,6 +40,7 @@
 
 #include "openlcb/Node.hxx"
 #include "openlcb/Defs.hxx"
+#include "openlcb/DenseNodes.hxx"
 #include "executor/Dispatcher.hxx"
 #include "executor/Service.hxx"
 #include "executor/Executor.hxx"
@@ -277,6 +278,13 @@ public:
         return addressedWriteFlow_;
     }
 
+    /** @return how many global messages the local nodes have sent on this
+     * interface since startup. */
+    unsigned global_messages_sent()
+    {
+        return globalMessagesSent_;
+    }
+
     /** Type of the dispatcher of incoming NMRAnet messages. */
     typedef DispatchFlow<Buffer<GenMessage>, 4> MessageDispatchFlow;
 
@@ -332,54 +340,100 @@ public:
         auto it = localNodes_.find(id);
         if (it == localNodes_.end())
         {
+            for (DenseNodeSet *s : denseNodes_)
+            {
+                Node *n = s->lookup(id);
+                if (n)
+                {
+                    return n;
+                }
+            }
             return nullptr;
         }
         return it->second;
     }
 
     /**
-     * @returns the first node (by nodeID order) that is registered in this
-     * interface as a local node, or nullptr if this interface has no local
-     * nodes.
+     * @returns the first node that is registered in this interface as a
+     * local node, or nullptr if this interface has no local nodes. The nodes
+     * of the local node map come first, then the DenseNodeSets in the order
+     * of registration.
      */
     Node* first_local_node() {
         auto it = localNodes_.begin();
-        if (it == localNodes_.end()) return nullptr;
+        if (it == localNodes_.end()) return first_dense_node(0);
         return it->second;
     }
 
     /**
-     * Iterator helper on the local nodes map.
+     * Iterator helper on the local nodes.
      *
      * @param previous is the node ID of a valid local node.
      *
-     * @returns the node pointer of the next local node (in node ID order) or
-     * null if this was the last node or an invalid argument (not the node ID
-     * of a local node).
+     * @returns the node pointer of the next local node (in the order
+     * described at first_local_node) or null if this was the last node or an
+     * invalid argument (not the node ID of a local node).
      */
     Node* next_local_node(NodeID previous) {
         auto it = localNodes_.find(previous);
         if (it == localNodes_.end())
         {
+            for (unsigned i = 0; i < denseNodes_.size(); ++i)
+            {
+                DenseNodeSet *s = denseNodes_[i];
+                if (s->lookup(previous))
+                {
+                    if (previous - s->base() + 1 < s->size())
+                    {
+                        return s->lookup(previous + 1);
+                    }
+                    return first_dense_node(i + 1);
+                }
+            }
             return nullptr;
         }
         ++it;
         if (it == localNodes_.end())
         {
-            return nullptr;
+            return first_dense_node(0);
         }
         return it->second;
     }
 
+    /** Registers a set of dense virtual nodes. Called by the DenseNodeSet
+     * constructor. The node IDs must not overlap with other local nodes.
+     * @param nodes is the set to add. */
+    void add_local_node_set(DenseNodeSet *nodes)
+    {
+        denseNodes_.push_back(nodes);
+    }
+
+    /** Removes a set of dense virtual nodes. Called by the DenseNodeSet
+     * destructor.
+     * @param nodes is the set to remove. */
+    void remove_local_node_set(DenseNodeSet *nodes);
+
     /** @returns true if the two node handles match as far as we can tell
      * without doing any network traffic. */
     virtual bool matching_node(NodeHandle expected,
                                NodeHandle actual) = 0;
 
+    /** Fills in the missing node ID or alias of a node handle from what the
+     * interface knows, without doing any network traffic. Must be called on
+     * the interface's executor. @param h is the handle to update. */
+    virtual void canonicalize_handle(NodeHandle *h)
+    {
+    }
+
 protected:
     void remove_local_node_from_map(Node *node) {
         auto it = localNodes_.find(node->node_id());
-        HASSERT(it != localNodes_.end());
+        if (it == localNodes_.end())
+        {
+            // Nodes of a DenseNodeSet are not in the map.
+            HASSERT(lookup_local_node(node->node_id()) == node);
+            return;
+        }
         localNodes_.erase(it);
     }
 
@@ -397,7 +451,30 @@ private:
     /// Local virtual nodes registered on this interface.
     VNodeMap localNodes_;
 
+    /// Blocks of dense virtual nodes registered on this interface.
+    std::vector<DenseNodeSet *> denseNodes_;
+
+    /// Number of global messages sent by the local nodes. Incremented by the
+    /// global write flow.
+    unsigned globalMessagesSent_{0};
+
+    /// @return the first node of the DenseNodeSets starting at a given index
+    /// in denseNodes_, or nullptr if there is none.
+    /// @param index is where in denseNodes_ to start.
+    Node *first_dense_node(unsigned index)
+    {
+        for (; index < denseNodes_.size(); ++index)
+        {
+            if (denseNodes_[index]->size())
+            {
+                return denseNodes_[index]->node(0);
+            }
+        }
+        return nullptr;
+    }
+
     friend class VerifyNodeIdHandler;
+    friend class WriteFlowBase; // increments globalMessagesSent_.
 
     DISALLOW_COPY_AND_ASSIGN(If);
 };
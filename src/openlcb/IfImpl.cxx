@@ -66,6 +66,7 @@ StateFlowBase::Action WriteFlowBase::send_to_local_node()
 
 StateFlowBase::Action WriteFlowBase::global_entry()
 {
+    ++async_if()->globalMessagesSent_;
     if (!message()->data()->has_flag_dst(
             GenMessage::WAIT_FOR_LOCAL_LOOPBACK))
     {
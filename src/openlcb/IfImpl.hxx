@@ -165,20 +165,22 @@ public:
         {
             // Addressed message.
             srcNode_ = m->dstNode;
-            it_ = iface()->localNodes_.end();
+#ifndef SIMPLE_NODE_ONLY
+            iterating_ = false;
+#endif
         }
         else if (!m->payload.empty() && m->payload.size() == 6)
         {
             // Global message with a node id included
             NodeID id = buffer_to_node_id(m->payload);
             srcNode_ = iface()->lookup_local_node(id);
-            if (!srcNode_)
+            if (!srcNode_ || !srcNode_->is_initialized())
             {
                 // Someone looking for a node that's not on this interface.
                 return release_and_exit();
             }
 #ifndef SIMPLE_NODE_ONLY
-            it_ = iface()->localNodes_.end();
+            iterating_ = false;
 #endif
         }
         else
@@ -196,15 +198,16 @@ public:
             ++it;
             HASSERT(it == iface()->localNodes_.end());
 #else
-            // We need to do an iteration over all local nodes.
-            it_ = iface()->localNodes_.begin();
-            if (it_ == iface()->localNodes_.end())
+            // We need to do an iteration over all local nodes. Nodes that
+            // have not been initialized yet (e.g. dense virtual nodes that
+            // were not activated) do not respond.
+            iterating_ = true;
+            srcNode_ = skip_uninitialized(iface()->first_local_node());
+            if (!srcNode_)
             {
                 // No local nodes.
                 return release_and_exit();
             }
-            srcNode_ = it_->second;
-            ++it_;
 #endif // not simple node.
         }
         if (srcNode_)
@@ -245,10 +248,16 @@ public:
          *
          * @TODO(balazs.racz): we should probably wait for the outgoing message
          * to be sent. */
-        if (it_ != iface()->localNodes_.end())
+        if (iterating_)
+        {
+            srcNode_ = skip_uninitialized(iface()->next_local_node(id));
+        }
+        else
+        {
+            srcNode_ = nullptr;
+        }
+        if (srcNode_)
         {
-            srcNode_ = it_->second;
-            ++it_;
             return allocate_and_call(iface()->global_message_write_flow(),
                                      STATE(send_response));
         }
@@ -257,13 +266,26 @@ public:
             return exit();
         }
     }
+
+    /// @return the first initialized local node starting from n (inclusive)
+    /// in the iteration order of the interface, or nullptr if there is none.
+    /// @param n is a local node or nullptr.
+    Node *skip_uninitialized(Node *n)
+    {
+        while (n && !n->is_initialized())
+        {
+            n = iface()->next_local_node(n->node_id());
+        }
+        return n;
+    }
 #endif // not simple node
 
 private:
     Node *srcNode_;
 
 #ifndef SIMPLE_NODE_ONLY
-    If::VNodeMap::Iterator it_;
+    /// True if we are responding to a global verify with all local nodes.
+    bool iterating_;
 #endif
 };
 } // namespace openlcb
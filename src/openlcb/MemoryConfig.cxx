@@ -64,6 +64,53 @@ void reboot()
 namespace openlcb
 {
 
+MemorySpace::address_t CompressedReadOnlyMemoryBlock::max_address()
+{
+    if (!size_)
+    {
+        // Runs the compressor once to the end to find out the size.
+        uint8_t buf[64];
+        compressor_.reset();
+        while (compressor_.read(buf, sizeof(buf)))
+        {
+        }
+        size_ = compressor_.offset();
+    }
+    return size_ - 1;
+}
+
+size_t CompressedReadOnlyMemoryBlock::read(address_t source, uint8_t *dst,
+    size_t len, errorcode_t *error, Notifiable *again)
+{
+    if (source < compressor_.offset())
+    {
+        compressor_.reset();
+    }
+    while (compressor_.offset() < source)
+    {
+        size_t skip = source - compressor_.offset();
+        if (skip > len)
+        {
+            skip = len;
+        }
+        // The output buffer is used as scratch space for skipping.
+        if (!compressor_.read(dst, skip))
+        {
+            break;
+        }
+    }
+    size_t count = 0;
+    if (compressor_.offset() == source)
+    {
+        count = compressor_.read(dst, len);
+    }
+    if (!count)
+    {
+        *error = MemoryConfigDefs::ERROR_OUT_OF_BOUNDS;
+    }
+    return count;
+}
+
 FileMemorySpace::FileMemorySpace(int fd, address_t len)
     : fileSize_(len)
     , name_(nullptr)
@@ -35,11 +35,14 @@
 #ifndef _NMRANET_MEMORYCONFIG_HXX_
 #define _NMRANET_MEMORYCONFIG_HXX_
 
+#include <limits.h>
+
 #include "openlcb/DatagramDefs.hxx"
 #include "openlcb/DatagramHandlerDefault.hxx"
 #include "openlcb/MemoryConfig.hxx"
 #include "utils/Destructable.hxx"
 #include "utils/ConfigUpdateService.hxx"
+#include "utils/LzCompressor.hxx"
 
 class Notifiable;
 
@@ -110,6 +113,8 @@ struct MemoryConfigDefs {
         SPACE_FDI        = 0xFA, /**< read-only for function definition XML */
         SPACE_FUNCTION   = 0xF9, /**< read-write for function data */
         SPACE_DCC_CV     = 0xF8, /**< proxy space for DCC functions */
+        SPACE_CDI_COMPRESSED = 0xF7, /**< CDI space, compressed with
+                                      * LzCompressor (OpenMRN extension) */
         SPACE_FIRMWARE   = 0xEF, /**< firmware upgrade space */
     };
 
@@ -173,6 +178,15 @@ struct MemoryConfigDefs {
         return p;
     }
 
+    static DatagramPayload read_datagram(
+        uint8_t space, uint32_t offset, uint8_t len)
+    {
+        DatagramPayload p = write_datagram(space, offset);
+        p[1] |= COMMAND_READ;
+        p.push_back(len);
+        return p;
+    }
+
 private:
     /** Do not instantiate this class. */
     MemoryConfigDefs();
@@ -301,6 +315,36 @@ private:
     const address_t len_; //< Length of block to serve.
 };
 
+/// Memory space implementation that exports some memory-mapped data (such as
+/// the cdi.xml) in compressed form. The compression happens on the fly as the
+/// reads arrive, thus no RAM is needed for either the original or the
+/// compressed data. Reads are expected to come sequentially; a read at an
+/// earlier offset restarts the compression from the beginning. Clients can
+/// use LzDecompressor to recover the original data.
+class CompressedReadOnlyMemoryBlock : public MemorySpace
+{
+public:
+    /** Initializes a memory block with a given block of memory. The address
+     * range [data, data+len) must be dereferenceable for read so long as this
+     * object is alive. It may point into read-only memory. */
+    CompressedReadOnlyMemoryBlock(const void *data, address_t len)
+        : compressor_(data, len)
+        , size_(0)
+    {
+    }
+
+    address_t max_address() OVERRIDE;
+
+    size_t read(address_t source, uint8_t *dst, size_t len, errorcode_t *error,
+                Notifiable *again) OVERRIDE;
+
+private:
+    /// Produces the compressed data.
+    LzCompressor compressor_;
+    /// Total length of the compressed data, or zero if not known yet.
+    address_t size_;
+};
+
 /// Memory space implementation that exports a some memory-mapped data as a
 /// read-write memory space. The data must be given as a void* pointer pointing
 /// to RAM (or other memory-mapped structures).
@@ -510,7 +554,8 @@ private:
             }
             case MemoryConfigDefs::COMMAND_UPDATE_COMPLETE:
             {
-                Singleton<ConfigUpdateService>::instance()->trigger_update();
+                Singleton<ConfigUpdateService>::instance()
+                    ->trigger_dirty_update();
                 return respond_ok(0);
             }
             case MemoryConfigDefs::COMMAND_RESET:
@@ -820,6 +865,21 @@ private:
                 return again();
             }
         }
+        if (currentOffset_ && Singleton<ConfigUpdateService>::exists())
+        {
+            // Lets the next config update call only the affected listeners.
+            if (get_space_number() == MemoryConfigDefs::SPACE_CONFIG)
+            {
+                Singleton<ConfigUpdateService>::instance()->mark_dirty(
+                    get_address(), currentOffset_);
+            }
+            else
+            {
+                // We do not know how other spaces map to the config file.
+                Singleton<ConfigUpdateService>::instance()->mark_dirty(
+                    0, UINT_MAX);
+            }
+        }
         char c = 0;
         int response_len = 6;
         if (has_custom_space())
@@ -104,6 +104,13 @@ public:
     {
     }
 
+    bool config_extent(unsigned *offset, unsigned *size) OVERRIDE
+    {
+        *offset = offset_.offset();
+        *size = size_ * config_entry_type::size();
+        return true;
+    }
+
     // Implementations for the event handler functions.
 
     void handle_identify_global(const EventRegistryEntry &registry_entry,
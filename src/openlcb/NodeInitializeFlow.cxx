@@ -41,6 +41,24 @@ InitializeFlow::~InitializeFlow()
 {
 }
 
+void InitializeFlow::set_bus_budget(
+    unsigned frames_per_sec, unsigned frames_per_node, unsigned burst)
+{
+    if (!frames_per_sec || !frames_per_node)
+    {
+        costNsec_ = 0;
+        return;
+    }
+    if (burst < frames_per_node)
+    {
+        burst = frames_per_node;
+    }
+    framesPerNode_ = frames_per_node;
+    frameNsec_ = SEC_TO_NSEC(1) / frames_per_sec;
+    costNsec_ = frames_per_node * frameNsec_;
+    burstNsec_ = SEC_TO_NSEC(burst - frames_per_node) / frames_per_sec;
+}
+
 void StartInitializationFlow(Node *node)
 {
     auto *g_initialize_flow = Singleton<InitializeFlow>::instance();
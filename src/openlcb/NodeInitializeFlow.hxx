@@ -61,17 +61,82 @@ typedef StateFlow<Buffer<InitializeRequest>, QList<1>> InitializeFlowBase;
 /// Usage: Create a global static instance of InitializeFlow. Allocate a
 /// Buffer<INitializerequest> and fill in the node pointer. Send the buffer via
 /// Singleton<InitializeFlow>::instance()->send(buffer)
+///
+/// The nodes are initialized one at a time. When a bus budget is set (see
+/// set_bus_budget), the start of each node is delayed such that the bring-up
+/// traffic does not exceed the given frame rate on average; this keeps the bus
+/// usable for other traffic when hundreds of nodes start at the same time.
+/// Each node is charged the estimated frame count when it starts, and the
+/// messages it sent beyond that estimate when its identify is done.
 class InitializeFlow : public InitializeFlowBase,
                        public Singleton<InitializeFlow>
 {
 public:
     InitializeFlow(Service *service)
         : InitializeFlowBase(service)
+        , timer_(this)
     {
+        set_bus_budget(config_node_init_frames_per_sec(),
+            config_node_init_frames_per_node(),
+            config_node_init_frame_burst());
     }
 
     ~InitializeFlow();
 
+    /// Sends a node initialization request to the flow.
+    /// @param msg is the request.
+    /// @param priority is ignored.
+    void send(Buffer<InitializeRequest> *msg,
+        unsigned priority = UINT_MAX) override
+    {
+        {
+            AtomicHolder h(this);
+            ++numRequested_;
+        }
+        InitializeFlowBase::send(msg, priority);
+    }
+
+    /// Sets the rate limit for bringing up nodes. The limit is a token bucket
+    /// over the number of frames each node sends during initialization
+    /// (initialization complete, alias allocation, producer and consumer
+    /// identified messages). Must be called on the executor or before any
+    /// node is initialized.
+    ///
+    /// @param frames_per_sec is the average frame rate the node bring-up may
+    /// use. 0 disables the rate limit.
+    /// @param frames_per_node is how many frames we account for a node before
+    /// it starts. Nodes that send more messages than this are charged for the
+    /// excess after their identify is done.
+    /// @param burst is the number of frames that may be sent at once after the
+    /// bus was idle. Must be at least frames_per_node.
+    void set_bus_budget(
+        unsigned frames_per_sec, unsigned frames_per_node, unsigned burst);
+
+    /// @return how many initialization requests arrived since startup.
+    unsigned num_requested()
+    {
+        return numRequested_;
+    }
+
+    /// @return how many nodes finished initialization since startup.
+    unsigned num_completed()
+    {
+        return numCompleted_;
+    }
+
+    /// @return how many nodes are waiting for or in initialization.
+    unsigned num_pending()
+    {
+        return numRequested_ - numCompleted_;
+    }
+
+    /// @return total time in nanoseconds that node initializations were
+    /// delayed due to the bus budget.
+    long long throttled_nsec()
+    {
+        return throttledNsec_;
+    }
+
 private:
     Node *node()
     {
@@ -81,6 +146,21 @@ private:
     Action entry() OVERRIDE
     {
         HASSERT(message()->data()->node);
+        if (costNsec_)
+        {
+            long long now = os_get_time_monotonic();
+            if (nextFree_ < now)
+            {
+                nextFree_ = now;
+            }
+            long long wait = nextFree_ - now - burstNsec_;
+            if (wait > 0)
+            {
+                throttledNsec_ += wait;
+                return sleep_and_call(&timer_, wait, STATE(entry));
+            }
+            nextFree_ += costNsec_;
+        }
         return allocate_and_call(
             node()->iface()->global_message_write_flow(),
             STATE(send_initialized));
@@ -90,6 +170,7 @@ private:
     {
         auto *b = get_allocation_result(
             node()->iface()->global_message_write_flow());
+        sentBefore_ = node()->iface()->global_messages_sent();
         done_.reset(this);
         NodeID id = node()->node_id();
         b->data()->reset(
@@ -111,7 +192,7 @@ private:
     {
         if (config_node_init_identify() != CONSTANT_TRUE)
         {
-            return release_and_exit();
+            return call_immediately(STATE(wait_for_local_identify));
         }
         // Get the dispatch flow.
         return allocate_and_call(
@@ -135,10 +216,47 @@ private:
 
     Action wait_for_local_identify()
     {
+        if (costNsec_)
+        {
+            // The identified messages are counted by the time the dispatcher
+            // is done, because the write flow notifies done after counting.
+            // Messages that other nodes sent meanwhile are charged too.
+            unsigned sent =
+                node()->iface()->global_messages_sent() - sentBefore_;
+            if (sent > framesPerNode_)
+            {
+                nextFree_ += (sent - framesPerNode_) * frameNsec_;
+            }
+        }
+        ++numCompleted_;
         return release_and_exit();
     }
 
     BarrierNotifiable done_;
+    /// Used for waiting for the bus budget.
+    StateFlowTimer timer_;
+    /// Time (os_get_time_monotonic) until which the bus budget is used up by
+    /// the nodes started so far.
+    long long nextFree_{0};
+    /// How much bus time the initialization of one node uses up, in nsec. 0
+    /// if there is no rate limit.
+    long long costNsec_{0};
+    /// How much bus time one frame uses up, in nsec.
+    long long frameNsec_{0};
+    /// How far ahead nextFree_ may be of the current time when starting a
+    /// node, in nsec.
+    long long burstNsec_{0};
+    /// Total time that nodes were delayed for the bus budget.
+    long long throttledNsec_{0};
+    /// How many frames are charged when a node starts.
+    unsigned framesPerNode_{0};
+    /// Global message count of the interface before the current node sent
+    /// initialization complete.
+    unsigned sentBefore_{0};
+    /// Number of requests that arrived.
+    unsigned numRequested_{0};
+    /// Number of nodes that are done.
+    unsigned numCompleted_{0};
 };
 
 /// Helper function that sends a local virtual node to the static
@@ -148,11 +266,12 @@ void StartInitializationFlow(Node *node);
 /// StateFlow that iterates through all local nodes and sends out node
 /// initialization complete for each of them. Used when a TCP disconnect event
 /// causes us to lose network connectivity and later the connection gets
-/// reestablished.
+/// reestablished. Nodes that are not initialized (such as the inactive nodes
+/// of a DenseNodeSet) are skipped.
 class ReinitAllNodes : public StateFlowBase {
 public:
     ReinitAllNodes(If* iface) : StateFlowBase(iface) {
-        nextNode_ = iface->first_local_node();
+        nextNode_ = skip_uninitialized(iface->first_local_node());
         start_flow(STATE(allocate_entry));
     }
 
@@ -173,10 +292,20 @@ private:
     }
 
     Action init_done() {
-        nextNode_ = iface()->next_local_node(nextNode_->node_id());
+        nextNode_ = skip_uninitialized(
+            iface()->next_local_node(nextNode_->node_id()));
         return call_immediately(STATE(allocate_entry));
     }
 
+    /// @return n or the first initialized local node after it; nullptr if
+    /// there is none.
+    Node* skip_uninitialized(Node* n) {
+        while (n && !n->is_initialized()) {
+            n = iface()->next_local_node(n->node_id());
+        }
+        return n;
+    }
+
     InitializeFlow* tgt() {
         return Singleton<InitializeFlow>::instance();
     }
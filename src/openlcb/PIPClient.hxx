@@ -33,6 +33,7 @@
  * @date 31 Oct 2015
  */
 
+#include "executor/CoroutineFlow.hxx"
 #include "executor/StateFlow.hxx"
 #include "openlcb/Defs.hxx"
 #include "openlcb/If.hxx"
@@ -107,7 +108,56 @@ public:
 
     };
 
-private:
+    /// Checks whether an incoming message is the response to a PIP request,
+    /// and if so, extracts the result.
+    ///
+    /// @param iface is the interface the request was sent on.
+    /// @param src is the node that sent the request.
+    /// @param dst is the node the request was sent to.
+    /// @param message is the incoming message.
+    /// @param error_code will be set to the result code (OPERATION_SUCCESS or
+    /// the error code from the remote node).
+    /// @param response will be set to the protocol bitmask upon success.
+    /// @return true if the message was the response, false if it should be
+    /// ignored.
+    static bool decode_response(If *iface, Node *src, NodeHandle dst,
+        Buffer<GenMessage> *message, uint32_t *error_code, uint64_t *response)
+    {
+        if (src != message->data()->dstNode ||
+            !iface->matching_node(dst, message->data()->src))
+        {
+            // Not from the right place.
+            return false;
+        }
+        if (message->data()->mti == Defs::MTI_OPTIONAL_INTERACTION_REJECTED ||
+            message->data()->mti == Defs::MTI_TERMINATE_DUE_TO_ERROR)
+        {
+            uint16_t mti, code;
+            buffer_to_error(message->data()->payload, &code, &mti, nullptr);
+            if (mti && mti != Defs::MTI_PROTOCOL_SUPPORT_INQUIRY)
+            {
+                // Got error response for a different interaction. Ignore.
+                return false;
+            }
+            *error_code = code;
+        }
+        else if (message->data()->mti == Defs::MTI_PROTOCOL_SUPPORT_REPLY)
+        {
+            *response = buffer_to_node_id(message->data()->payload);
+            *error_code = OPERATION_SUCCESS;
+        }
+        else
+        {
+            // Dunno what this MTI is. Ignore.
+            LOG(INFO, "Unexpected MTI for PIP response handler: %04x",
+                message->data()->mti);
+            return false;
+        }
+        *error_code &= ~OPERATION_PENDING;
+        return true;
+    }
+
+    /// MTI and mask pairs of the messages that may carry the response.
     enum
     {
         MTI_1a = Defs::MTI_TERMINATE_DUE_TO_ERROR,
@@ -119,6 +169,7 @@ private:
         MASK_2 = Defs::MTI_EXACT,
     };
 
+private:
     Action request_buffer()
     {
         return allocate_and_call(
@@ -147,40 +198,12 @@ private:
     void handle_response(Buffer<GenMessage> *message)
     {
         AutoReleaseBuffer<GenMessage> rb(message);
-        if (src_ != message->data()->dstNode ||
-            !iface()->matching_node(dst_, message->data()->src))
+        if (!decode_response(
+                iface(), src_, dst_, message, &errorCode_, &pipResponse_))
         {
-            // Not from the right place.
             return;
         }
-        if (message->data()->mti == Defs::MTI_OPTIONAL_INTERACTION_REJECTED ||
-            message->data()->mti == Defs::MTI_TERMINATE_DUE_TO_ERROR)
-        {
-            uint16_t mti, error_code;
-            buffer_to_error(
-                message->data()->payload, &error_code, &mti, nullptr);
-            if (mti && mti != Defs::MTI_PROTOCOL_SUPPORT_INQUIRY)
-            {
-                // Got error response for a different interaction. Ignore.
-                return;
-            }
-            errorCode_ = error_code;
-        }
-        else if (message->data()->mti == Defs::MTI_PROTOCOL_SUPPORT_REPLY)
-        {
-            pipResponse_ = buffer_to_node_id(message->data()->payload);
-            errorCode_ = OPERATION_SUCCESS;
-        }
-        else
-        {
-            // Dunno what this MTI is. Ignore.
-            LOG(INFO, "Unexpected MTI for PIP response handler: %04x",
-                message->data()->mti);
-            return;
-        }
-
         // Wakes up parent flow.
-        errorCode_ &= ~OPERATION_PENDING;
         timer_.trigger();
     }
 
@@ -229,4 +252,113 @@ private:
     PIPResponseHandler responseHandler_{this};
 };
 
+#if __cpp_impl_coroutine
+
+/// The PIPClient written as a coroutine (see CoroutineFlow). Same usage and
+/// results as PIPClient. Only available when compiling with -std=c++20.
+///
+/// The state flow needs three executor runs per request: one to start, one
+/// after the buffer allocation and one after the response. This one
+/// allocates synchronously when the pool has memory, so it needs two.
+class CoroutinePIPClient : public CoroutineFlow
+{
+public:
+    CoroutinePIPClient(If *iface)
+        : CoroutineFlow(iface)
+    {
+    }
+
+    /// Sends a PIP request to the specified node. See PIPClient::request().
+    ///
+    /// @param dst is the target node to query
+    /// @param src is the source node from which to send query
+    /// @param done will be notified if the request succeeds or fails or
+    /// timeouts)
+    void request(NodeHandle dst, Node *src, Notifiable *done)
+    {
+        src_ = src;
+        dst_ = dst;
+        done_ = done;
+        errorCode_ = PIPClient::OPERATION_PENDING;
+        pipResponse_ = 0;
+        start();
+    }
+
+    /** @return the error code of the last request, or one of the internal
+     * error codes from \ref PIPClient::ResultCodes */
+    uint32_t error_code()
+    {
+        return errorCode_;
+    }
+
+    /** Returns the response of the last request out, or unspecified if the
+     * last request has not succeeded. */
+    uint64_t response()
+    {
+        return pipResponse_;
+    }
+
+private:
+    Task body() override
+    {
+        auto *b = co_await allocate(iface()->addressed_message_write_flow());
+        b->data()->reset(Defs::MTI_PROTOCOL_SUPPORT_INQUIRY, src_->node_id(),
+            dst_, EMPTY_PAYLOAD);
+
+        iface()->dispatcher()->register_handler(
+            &responseHandler_, PIPClient::MTI_1, PIPClient::MASK_1);
+        iface()->dispatcher()->register_handler(
+            &responseHandler_, PIPClient::MTI_2, PIPClient::MASK_2);
+
+        iface()->addressed_message_write_flow()->send(b);
+
+        co_await sleep(PIP_CLIENT_TIMEOUT_NSEC);
+        if (errorCode_ & PIPClient::OPERATION_PENDING)
+        {
+            errorCode_ = PIPClient::TIMEOUT;
+        }
+        iface()->dispatcher()->unregister_handler_all(&responseHandler_);
+        done_->notify();
+    }
+
+    /// Message handler for incoming PIP responses. Wakes up the coroutine
+    /// when the response arrived.
+    class PIPResponseHandler : public MessageHandler
+    {
+    public:
+        PIPResponseHandler(CoroutinePIPClient *parent)
+            : parent_(parent)
+        {
+        }
+
+        void send(Buffer<GenMessage> *message, unsigned priority) override
+        {
+            AutoReleaseBuffer<GenMessage> rb(message);
+            if (PIPClient::decode_response(parent_->iface(), parent_->src_,
+                    parent_->dst_, message, &parent_->errorCode_,
+                    &parent_->pipResponse_))
+            {
+                parent_->timer().trigger();
+            }
+        }
+
+    private:
+        CoroutinePIPClient *parent_;
+    };
+
+    If *iface()
+    {
+        return static_cast<If *>(service());
+    }
+
+    Node *src_;
+    Notifiable *done_;
+    NodeHandle dst_;
+    uint64_t pipResponse_{0};
+    uint32_t errorCode_{PIPClient::IDLE};
+    PIPResponseHandler responseHandler_{this};
+};
+
+#endif // __cpp_impl_coroutine
+
 } // namespace openlcb
@@ -0,0 +1,155 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file SimpleInfoProtocol.cxx
+ *
+ * Helper functions for SNIP and similar protocols.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include "openlcb/SimpleInfoProtocol.hxx"
+
+namespace openlcb
+{
+
+namespace
+{
+
+/// Reads a block of data from a file for render_simple_info.
+class SimpleInfoFileReader
+{
+public:
+    ~SimpleInfoFileReader()
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+    }
+
+    /// Reads data from a file. Bytes beyond the end of the file read as zero.
+    /// @param d is the descriptor entry; data is the file name, arg2 the
+    /// offset.
+    /// @param len how many bytes to read.
+    /// @param buf will be filled with the data.
+    void read(const SimpleInfoDescriptor &d, unsigned len, uint8_t *buf)
+    {
+        const char *file_name = d.data;
+        HASSERT(file_name);
+        if (!fileName_ || strcmp(fileName_, file_name))
+        {
+            if (fd_ >= 0)
+            {
+                ::close(fd_);
+            }
+            fileName_ = file_name;
+            fd_ = ::open(fileName_, O_RDONLY);
+            HASSERT(fd_ >= 0);
+        }
+        int ret = lseek(fd_, d.arg2, SEEK_SET);
+        HASSERT(ret != -1);
+        memset(buf, 0, len);
+        unsigned ofs = 0;
+        while (ofs < len)
+        {
+            ret = ::read(fd_, buf + ofs, len - ofs);
+            HASSERT(ret >= 0);
+            if (ret == 0)
+            {
+                break;
+            }
+            ofs += ret;
+        }
+    }
+
+private:
+    /// Last file name we opened.
+    const char *fileName_{nullptr};
+    /// fd of the last file we opened.
+    int fd_{-1};
+};
+
+} // namespace
+
+void render_simple_info(const SimpleInfoDescriptor *desc, string *out)
+{
+    out->clear();
+    SimpleInfoFileReader reader;
+    uint8_t buf[256];
+    for (; desc->cmd != SimpleInfoDescriptor::END_OF_DATA; ++desc)
+    {
+        const SimpleInfoDescriptor &d = *desc;
+        switch (d.cmd)
+        {
+            case SimpleInfoDescriptor::LITERAL_BYTE:
+                if (d.data)
+                {
+                    HASSERT(d.arg == *d.data);
+                }
+                out->push_back(d.arg);
+                break;
+            case SimpleInfoDescriptor::C_STRING:
+            {
+                size_t len = strlen(d.data);
+                if (d.arg && d.arg <= len)
+                {
+                    // Clips too long messages.
+                    len = d.arg - 1;
+                }
+                out->append(d.data, len);
+                out->push_back(0);
+                break;
+            }
+            case SimpleInfoDescriptor::CHAR_ARRAY:
+                out->append(d.data, d.arg);
+                break;
+            case SimpleInfoDescriptor::FILE_LITERAL_BYTE:
+                reader.read(d, 1, buf);
+                HASSERT(d.arg == buf[0]);
+                out->push_back(d.arg);
+                break;
+            case SimpleInfoDescriptor::FILE_C_STRING:
+            {
+                HASSERT(d.arg);
+                reader.read(d, d.arg - 1, buf);
+                buf[d.arg - 1] = 0;
+                out->append((const char *)buf);
+                out->push_back(0);
+                break;
+            }
+            case SimpleInfoDescriptor::FILE_CHAR_ARRAY:
+                reader.read(d, d.arg, buf);
+                out->append((const char *)buf, d.arg);
+                break;
+            default:
+                DIE("Unexpected descriptor type.");
+        }
+    }
+}
+
+} // namespace openlcb
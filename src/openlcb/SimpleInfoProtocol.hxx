@@ -104,6 +104,14 @@ struct SimpleInfoDescriptor
     const char *data;
 };
 
+/// Assembles the entire payload described by a descriptor array, with the
+/// same contents as SimpleInfoFlow would send. Data from files is read with
+/// one read() call per descriptor entry. Useful for caching a response.
+///
+/// @param desc is the descriptor array; must end with an END_OF_DATA entry.
+/// @param out will be filled with the payload.
+void render_simple_info(const SimpleInfoDescriptor *desc, string *out);
+
 /// Base class for the SimpleInfoFlow.
 typedef StateFlow<Buffer<SimpleInfoResponse>, QList<1>> SimpleInfoFlowBase;
 
@@ -361,10 +369,29 @@ private:
                                             ->addressed_message_write_flow());
         const SimpleInfoResponse &r = *message()->data();
         b->data()->reset(r.mti, r.src->node_id(), r.dst, EMPTY_PAYLOAD);
-        for (uint8_t offset = 0; offset < maxBytesPerMessage_ && !is_eof();
-             ++offset, step_byte())
+        unsigned offset = 0;
+        while (offset < maxBytesPerMessage_ && !is_eof())
         {
+            const SimpleInfoDescriptor &d = current_descriptor();
+            if (d.cmd == SimpleInfoDescriptor::CHAR_ARRAY)
+            {
+                // In-memory data (such as a cached response) is copied in
+                // one go.
+                unsigned len = std::min<unsigned>(
+                    currentLength_ - byteOffset_, maxBytesPerMessage_ - offset);
+                b->data()->payload.append(d.data + byteOffset_, len);
+                offset += len;
+                byteOffset_ += len;
+                if (byteOffset_ >= currentLength_)
+                {
+                    ++entryOffset_;
+                    update_for_next_entry();
+                }
+                continue;
+            }
             b->data()->payload.push_back(current_byte());
+            ++offset;
+            step_byte();
         }
         b->data()->set_flag_dst(GenMessage::WAIT_FOR_LOCAL_LOOPBACK);
         if (useContinueBits_)
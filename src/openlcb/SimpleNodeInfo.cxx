@@ -51,6 +51,45 @@ const SimpleInfoDescriptor SNIPHandler::SNIP_RESPONSE[] = {
     {SimpleInfoDescriptor::FILE_C_STRING, 64, 64, SNIP_DYNAMIC_FILENAME},
     {SimpleInfoDescriptor::END_OF_DATA, 0, 0, 0}};
 
+const SimpleInfoDescriptor *SNIPHandler::ResponseCache::get(BufferBase *b)
+{
+    unsigned writes =
+        Singleton<ConfigUpdateService>::instance()->write_count();
+    if (writes != writeCount_)
+    {
+        // The user name or description may have been written.
+        writeCount_ = writes;
+        valid_ = false;
+    }
+    if (!valid_)
+    {
+        if (!inUse_.is_done())
+        {
+            // Responses still being sent point to data_.
+            return SNIP_RESPONSE;
+        }
+        string payload;
+        render_simple_info(SNIP_RESPONSE, &payload);
+        HASSERT(payload.size() <= sizeof(data_));
+        memcpy(data_, payload.data(), payload.size());
+        descriptor_[0] = {SimpleInfoDescriptor::CHAR_ARRAY,
+            (uint8_t)payload.size(), 0, data_};
+        descriptor_[1] = {SimpleInfoDescriptor::END_OF_DATA, 0, 0, nullptr};
+        valid_ = true;
+        ++renderCount_;
+    }
+    if (inUse_.is_done())
+    {
+        inUse_.reset(EmptyNotifiable::DefaultInstance());
+    }
+    else
+    {
+        inUse_.new_child();
+    }
+    b->set_done(&inUse_);
+    return descriptor_;
+}
+
 void init_snip_user_file(int fd, const char *user_name,
                          const char *user_description)
 {
@@ -37,6 +37,8 @@
 
 #include "openlcb/If.hxx"
 #include "openlcb/SimpleInfoProtocol.hxx"
+#include "utils/ConfigUpdateListener.hxx"
+#include "utils/ConfigUpdateService.hxx"
 
 namespace openlcb
 {
@@ -73,6 +75,9 @@ extern const SimpleNodeStaticValues SNIP_STATIC_DATA;
 /** The SNIP dynamic data will be read from this file. It should be 128 bytes
  *  long, and include the version number of "2" at the beginning. */
 extern const char *const SNIP_DYNAMIC_FILENAME;
+/** The config file that the ConfigUpdateService operates on; nullptr if the
+ *  node has no configuration file. */
+extern const char *const CONFIG_FILENAME;
 
 /** Helper function for test nodes. Fills a file with the given SNIP user
  * values. */
@@ -84,6 +89,13 @@ void init_snip_user_file(int fd, const char *user_name,
 /// Uses the generic SimpleInfoProtocol handler with a specific response
 /// structure (@ref SNIPHandler::SNIP_RESPONSE) to assemble the necessary
 /// response packets.
+///
+/// If there is a ConfigUpdateService with a config file, the response is
+/// rendered only once and then served from memory, without reading the user
+/// data file. The cached response is thrown away on every write to the
+/// configuration and on every configuration update. It is rendered again once
+/// no response is being sent from it; until then the responses are rendered
+/// by SimpleInfoFlow from the files.
 class SNIPHandler : public IncomingMessageStateFlow
 {
 public:
@@ -93,6 +105,10 @@ public:
         , responseFlow_(response_flow)
     {
         HASSERT(SNIP_STATIC_DATA.version == 4);
+        if (Singleton<ConfigUpdateService>::exists() && CONFIG_FILENAME)
+        {
+            cache_.reset(new ResponseCache());
+        }
         iface->dispatcher()->register_handler(
             this, Defs::MTI_IDENT_INFO_REQUEST, Defs::MTI_EXACT);
     }
@@ -115,15 +131,74 @@ public:
     Action send_response_request()
     {
         auto *b = get_allocation_result(responseFlow_);
-        b->data()->reset(nmsg(), SNIP_RESPONSE, Defs::MTI_IDENT_INFO_REPLY);
+        b->data()->reset(nmsg(), cache_ ? cache_->get(b) : SNIP_RESPONSE,
+            Defs::MTI_IDENT_INFO_REPLY);
         responseFlow_->send(b);
         return release_and_exit();
     }
 
+    /// @return how many times the response was rendered into the cache.
+    unsigned cache_renders()
+    {
+        return cache_ ? cache_->renderCount_ : 0;
+    }
+
 private:
+    /// Maximum length of a SNIP response: two version bytes, four static
+    /// strings and the two user strings, with their terminating zeros.
+    static constexpr unsigned MAX_SIZE = 2 +
+        sizeof(SimpleNodeStaticValues::manufacturer_name) +
+        sizeof(SimpleNodeStaticValues::model_name) +
+        sizeof(SimpleNodeStaticValues::hardware_version) +
+        sizeof(SimpleNodeStaticValues::software_version) +
+        sizeof(SimpleNodeDynamicValues::user_name) +
+        sizeof(SimpleNodeDynamicValues::user_description);
+
+    /// Holds the pre-rendered SNIP response.
+    class ResponseCache : public DefaultConfigUpdateListener
+    {
+    public:
+        UpdateAction apply_configuration(
+            int fd, bool initial_load, BarrierNotifiable *done) override
+        {
+            AutoNotify n(done);
+            valid_ = false;
+            return UPDATED;
+        }
+
+        void factory_reset(int fd) override
+        {
+            valid_ = false;
+        }
+
+        /// @param b is the response that will be sent from the returned
+        /// descriptor. If that is the cache, b will release it when done.
+        ///
+        /// @return descriptor for sending the response; renders it if
+        /// needed.
+        const SimpleInfoDescriptor *get(BufferBase *b);
+
+        /// data_ is up to date.
+        bool valid_{false};
+        /// ConfigUpdateService::write_count() when data_ was rendered.
+        unsigned writeCount_{0};
+        /// Statistics: how many times we rendered the response.
+        unsigned renderCount_{0};
+        /// Has one child for every response that is being sent from data_.
+        /// data_ is only rendered again when this is done.
+        BarrierNotifiable inUse_;
+        /// Rendered response.
+        char data_[MAX_SIZE];
+        /// Descriptor sending data_.
+        SimpleInfoDescriptor descriptor_[2];
+    };
+
     /** Defines the SNIP response fields. */
     static const SimpleInfoDescriptor SNIP_RESPONSE[];
 
+    /// Cached response, or nullptr if caching is not possible.
+    std::unique_ptr<ResponseCache> cache_;
+
     Node* node_;
     SimpleInfoFlow *responseFlow_;
 };
@@ -112,11 +112,19 @@ void SimpleCanStackBase::default_start_node()
     }
     {
         auto *space = new ReadOnlyMemoryBlock(
-            reinterpret_cast<const uint8_t *>(&CDI_DATA), strlen(CDI_DATA) + 1);
+            reinterpret_cast<const uint8_t *>(cdiData_), strlen(cdiData_) + 1);
         memoryConfigHandler_.registry()->insert(
             node(), MemoryConfigDefs::SPACE_CDI, space);
         additionalComponents_.emplace_back(space);
     }
+    if (config_enable_compressed_cdi_space() == CONSTANT_TRUE)
+    {
+        auto *space =
+            new CompressedReadOnlyMemoryBlock(cdiData_, strlen(cdiData_) + 1);
+        memoryConfigHandler_.registry()->insert(
+            node(), MemoryConfigDefs::SPACE_CDI_COMPRESSED, space);
+        additionalComponents_.emplace_back(space);
+    }
     if (CONFIG_FILENAME != nullptr)
     {
         auto *space = new FileMemorySpace(CONFIG_FILENAME, CONFIG_FILE_SIZE);
@@ -270,32 +278,25 @@ void SimpleCanStackBase::check_version_and_factory_reset(
     }
 }
 
-/// Contains an array describing each position in the Configuration space that
-/// is occupied by an Event ID from a producer or consumer. These Event IDs
-/// will be reset to increasing event numbers upon factory reset. The array is
-/// exported by the cdi compilation mechanism (in CompileCdiMain.cxx) and
-/// defined by cdi.o for the linker.
-extern const uint16_t CDI_EVENT_OFFSETS[];
-
 void SimpleCanStackBase::factory_reset_all_events(
     const InternalConfigData &cfg, int fd)
 {
     // First we find the event count.
     uint16_t new_next_event = cfg.next_event().read(fd);
     uint16_t next_event = new_next_event;
-    for (unsigned i = 0; CDI_EVENT_OFFSETS[i]; ++i)
+    for (unsigned i = 0; cdiEventOffsets_[i]; ++i)
     {
         ++new_next_event;
     }
     // We block off the event IDs first.
     cfg.next_event().write(fd, new_next_event);
     // Then we write them to eeprom.
-    for (unsigned i = 0; CDI_EVENT_OFFSETS[i]; ++i)
+    for (unsigned i = 0; cdiEventOffsets_[i]; ++i)
     {
         EventId id = node()->node_id();
         id <<= 16;
         id |= next_event++;
-        EventConfigEntry(CDI_EVENT_OFFSETS[i]).write(fd, id);
+        EventConfigEntry(cdiEventOffsets_[i]).write(fd, id);
     }
 }
 
@@ -39,6 +39,7 @@
 
 #include "executor/Executor.hxx"
 #include "openlcb/AliasAllocator.hxx"
+#include "openlcb/CompiledCdi.hxx"
 #include "openlcb/ConfigRepresentation.hxx"
 #include "openlcb/ConfigUpdateFlow.hxx"
 #include "openlcb/DatagramCan.hxx"
@@ -65,6 +66,13 @@ namespace openlcb
 /// This symbol contains the embedded text of the CDI xml file.
 extern const char CDI_DATA[];
 
+/// Contains an array describing each position in the Configuration space that
+/// is occupied by an Event ID from a producer or consumer. These Event IDs
+/// will be reset to increasing event numbers upon factory reset. The array is
+/// exported by the cdi compilation mechanism (in CompileCdiMain.cxx) and
+/// defined by cdi.o for the linker.
+extern const uint16_t CDI_EVENT_OFFSETS[];
+
 /// This symbol must be defined by the application to tell which file to open
 /// for the configuration listener.
 extern const char *const CONFIG_FILENAME;
@@ -143,6 +151,20 @@ public:
         return &memoryConfigHandler_;
     }
 
+#ifdef HAVE_CONSTEXPR_CDI
+    /// Serves the cdi.xml and uses the event offsets rendered by the compiler
+    /// (see CompiledCdi) instead of CDI_DATA and CDI_EVENT_OFFSETS from the
+    /// cdi.o made by compile_cdi. Call before the stack is started.
+    ///
+    /// @param CdiType is the CDI definition, usually ConfigDef from
+    /// config.hxx.
+    template <class CdiType> void use_compiled_cdi()
+    {
+        cdiData_ = CompiledCdi<CdiType>::DATA.data();
+        cdiEventOffsets_ = CompiledCdi<CdiType>::EVENT_OFFSETS.data();
+    }
+#endif
+
     /// Adds a CAN bus port with synchronous driver API.
     void add_can_port_blocking(const char *device)
     {
@@ -335,6 +357,11 @@ protected:
 
     /// Stores and keeps ownership of optional components.
     std::vector<std::unique_ptr<Destructable>> additionalComponents_;
+
+    /// The cdi.xml served in the CDI memory space, null-terminated.
+    const char *cdiData_{CDI_DATA};
+    /// Zero-terminated offsets of the event IDs in the config space.
+    const uint16_t *cdiEventOffsets_{CDI_EVENT_OFFSETS};
 };
 
 /// CAN-based stack with DefaultNode.
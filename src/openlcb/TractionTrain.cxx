@@ -36,6 +36,11 @@
 
 #include "openlcb/TractionTrain.hxx"
 
+#include <memory>
+#include <vector>
+
+#include "executor/Executor.hxx"
+#include "nmranet_config.h"
 #include "utils/logging.h"
 #include "openlcb/If.hxx"
 
@@ -87,30 +92,41 @@ If *TrainNode::iface()
 struct TrainService::Impl
 {
     class TractionRequestFlow;
+    class ShardRouter;
+    struct Shard;
 
-    Impl(TrainService *parent) : traction_(parent)
-    {
-    }
+    Impl(TrainService *parent, unsigned num_shards);
+    ~Impl();
 
     /// Handler for incoming OpenLCB messages of MTI == Traction Protocol
     /// Request.
-    class TractionRequestFlow : public IncomingMessageStateFlow
+    class TractionRequestFlow : public MessageStateFlowBase
     {
     public:
-        TractionRequestFlow(TrainService *service)
-            : IncomingMessageStateFlow(service->iface())
+        /// Constructor. @param train_service is the parent. @param service
+        /// defines which executor the requests are processed on. @param shard
+        /// is the index of the shard this flow serves. @param lock protects
+        /// the trains of the shard, nullptr if there are no shards.
+        TractionRequestFlow(TrainService *train_service, Service *service,
+            unsigned shard, OSMutex *lock)
+            : MessageStateFlowBase(service)
             , reserved_(0)
-            , trainService_(service)
+            , shard_(shard)
+            , lock_(lock)
+            , trainService_(train_service)
             , response_(nullptr)
         {
-            iface()->dispatcher()->register_handler(
-                this, Defs::MTI_TRACTION_CONTROL_COMMAND, 0xffff);
         }
 
-        ~TractionRequestFlow()
+        If *iface()
+        {
+            return trainService_->iface();
+        }
+
+        /// @return the NMRAnet message we received.
+        GenMessage *nmsg()
         {
-            iface()->dispatcher()->unregister_handler(
-                this, Defs::MTI_TRACTION_CONTROL_COMMAND, 0xffff);
+            return message()->data();
         }
 
     protected:
@@ -119,6 +135,28 @@ struct TrainService::Impl
             return static_cast<TrainNode *>(nmsg()->dstNode);
         }
 
+        /// Compares two node handles. The alias caches of the interface may
+        /// only be accessed on the interface executor, so when running in a
+        /// shard, only what is in the handles is compared; the shard router
+        /// has already filled in the source handle of the request. @return
+        /// true if the two node handles match.
+        bool matching_node(NodeHandle expected, NodeHandle actual)
+        {
+            if (service()->executor() == iface()->executor())
+            {
+                return iface()->matching_node(expected, actual);
+            }
+            if (expected.id && actual.id)
+            {
+                return expected.id == actual.id;
+            }
+            if (expected.alias && actual.alias)
+            {
+                return expected.alias == actual.alias;
+            }
+            return false;
+        }
+
         Action maybe_alloc_response(Callback c)
         {
             if (response_)
@@ -150,8 +188,14 @@ struct TrainService::Impl
                 return release_and_exit();
             }
             // Checks if destination is a local traction-enabled node.
-            if (trainService_->nodes_.find(train_node()) ==
-                trainService_->nodes_.end())
+            bool found;
+            {
+                AtomicHolder h(trainService_);
+                auto it = trainService_->nodes_.find(train_node());
+                found = it != trainService_->nodes_.end() &&
+                    it->second == shard_;
+            }
+            if (!found)
             {
                 LOG(VERBOSE, "Traction message for node %p that is not "
                              "traction enabled.",
@@ -168,6 +212,7 @@ struct TrainService::Impl
                 return reject_permanent();
             }
             uint8_t cmd = payload()[0];
+            TrainLock l(lock_);
             switch (cmd)
             {
                 /** @TODO(balazs.racz) need to validate caller of mutating
@@ -177,8 +222,7 @@ struct TrainService::Impl
                 {
                     SpeedType sp = fp16_to_speed(payload() + 1);
                     train_node()->train()->set_speed(sp);
-                    nextConsistIndex_ = 0;
-                    return call_immediately(STATE(maybe_forward_consist));
+                    return call_immediately(STATE(forward_consist));
                 }
                 case TractionDefs::REQ_SET_FN:
                 {
@@ -191,8 +235,7 @@ struct TrainService::Impl
                     value <<= 8;
                     value |= payload()[5];
                     train_node()->train()->set_fn(address, value);
-                    nextConsistIndex_ = 0;
-                    return call_immediately(STATE(maybe_forward_consist));
+                    return call_immediately(STATE(forward_consist));
                 }
                 case TractionDefs::REQ_EMERGENCY_STOP:
                 {
@@ -231,6 +274,7 @@ struct TrainService::Impl
         {
             Payload *p = initialize_response();
             uint8_t cmd = payload()[0];
+            TrainLock l(lock_);
             switch (cmd)
             {
                 case TractionDefs::REQ_QUERY_SPEED:
@@ -272,6 +316,7 @@ struct TrainService::Impl
         {
             Payload &p = *initialize_response();
             uint8_t subcmd = payload()[1];
+            TrainLock l(lock_);
             switch (subcmd)
             {
                 case TractionDefs::CTRLREQ_ASSIGN_CONTROLLER:
@@ -294,8 +339,8 @@ struct TrainService::Impl
                         train_node()->get_controller();
                     if (false && // TODO(balazs.racz) this will automatically "steal" the loco but forgets to notify the old controller that it's stolen.
                         existing_controller.id &&
-                        !iface()->matching_node(existing_controller,
-                                                supplied_controller))
+                        !matching_node(existing_controller,
+                                       supplied_controller))
                     {
                         /** @TODO (balazs.racz): we need to implement stealing
                          * a train from the existing controller. */
@@ -338,8 +383,8 @@ struct TrainService::Impl
                     }
                     NodeHandle existing_controller =
                         train_node()->get_controller();
-                    if (!iface()->matching_node(existing_controller,
-                                                    supplied_controller))
+                    if (!matching_node(existing_controller,
+                                       supplied_controller))
                     {
                         LOG(WARNING,
                             "Tried to release a train that was not held: "
@@ -360,6 +405,7 @@ struct TrainService::Impl
         Action handle_consist_config()
         {
             uint8_t cmd = payload()[1];
+            TrainLock l(lock_);
             switch (cmd)
             {
                 case TractionDefs::CNSTREQ_ATTACH_NODE:
@@ -408,88 +454,84 @@ struct TrainService::Impl
             }
         }
 
-        Action maybe_forward_consist()
+        /// Forwards the incoming speed or function command to every consist
+        /// member in a single pass over the consist list. All members but
+        /// the last one get a synchronously allocated copy; the last one gets
+        /// the incoming message buffer itself. This way there is no executor
+        /// round-trip per consist member.
+        Action forward_consist()
         {
-            auto* train_node = this->train_node();
-            unsigned count = train_node->query_consist_length();
-            if (count <= nextConsistIndex_)
-                return release_and_exit();
-            uint8_t flags = 0;
-            NodeID dst = train_node->query_consist(nextConsistIndex_, &flags);
-            if (iface()->matching_node(nmsg()->src, NodeHandle(dst)))
+            auto *train_node = this->train_node();
+            TrainLock l(lock_);
+            ConsistEntry *pending = nullptr;
+            for (auto it = train_node->consist_begin();
+                 it != train_node->consist_end(); ++it)
             {
-                ++nextConsistIndex_;
-                return again();
-            }
-            uint8_t cmd = payload()[0];
-            bool flip_speed = false;
-            if (cmd == TractionDefs::REQ_SET_SPEED) {
-                if (flags & TractionDefs::CNSTFLAGS_REVERSE) {
-                    flip_speed = true;
-                }
-            } else if (cmd == TractionDefs::REQ_SET_FN) {
-                uint32_t address = payload()[1];
-                address <<= 8;
-                address |= payload()[2];
-                address <<= 8;
-                address |= payload()[3];
-                if (address == 0) {
-                    if ((flags & TractionDefs::CNSTFLAGS_LINKF0) == 0) {
-                        // skip
-                        ++nextConsistIndex_;
-                        return again();
-                    }
-                } else {
-                    if ((flags & TractionDefs::CNSTFLAGS_LINKFN) == 0) {
-                        // skip
-                        ++nextConsistIndex_;
-                        return again();
-                    }
+                if (!should_forward(&*it))
+                {
+                    continue;
                 }
-            }
-            if (count == nextConsistIndex_ + 1u)
-            {
-                // last node: we can transfer the message.
-                auto *b = transfer_message();
-                b->data()->src = NodeHandle(train_node->node_id());
-                b->data()->dst = NodeHandle(dst);
-                b->data()->dstNode = nullptr;
-                if (flip_speed) {
-                    b->data()->payload[1] ^= 0x80;
+                if (pending)
+                {
+                    auto *b = iface()->addressed_message_write_flow()->alloc();
+                    b->data()->reset(message()->data()->mti,
+                        train_node->node_id(),
+                        NodeHandle(pending->get_slave()),
+                        message()->data()->payload);
+                    maybe_flip_speed(pending, b->data());
+                    iface()->addressed_message_write_flow()->send(b);
                 }
-                iface()->addressed_message_write_flow()->send(b);
-                return exit();
+                pending = &*it;
             }
-            else
+            if (!pending)
             {
-                return allocate_and_call(
-                    iface()->addressed_message_write_flow(),
-                    STATE(forward_consist));
+                return release_and_exit();
             }
+            // last node: we can transfer the message.
+            maybe_flip_speed(pending, nmsg());
+            auto *b = transfer_message();
+            b->data()->src = NodeHandle(train_node->node_id());
+            b->data()->dst = NodeHandle(pending->get_slave());
+            b->data()->dstNode = nullptr;
+            iface()->addressed_message_write_flow()->send(b);
+            return exit();
         }
 
-        Action forward_consist()
+        /// @return true if the current incoming command should be forwarded
+        /// to a given consist member. @param e is the consist member.
+        bool should_forward(ConsistEntry *e)
         {
-            auto *b =
-                get_allocation_result(iface()->addressed_message_write_flow());
-            uint8_t flags;
-            NodeID dst = train_node()->query_consist(nextConsistIndex_, &flags);
-            if (!dst)
+            if (matching_node(nmsg()->src, NodeHandle(e->get_slave())))
             {
-                // Strange. The consist destination should exist and never be
-                // zero once we got here.
-                b->unref();
-                return release_and_exit();
+                // Do not send the command back to where it came from.
+                return false;
+            }
+            if (payload()[0] != TractionDefs::REQ_SET_FN)
+            {
+                return true;
+            }
+            uint32_t address = payload()[1];
+            address <<= 8;
+            address |= payload()[2];
+            address <<= 8;
+            address |= payload()[3];
+            if (address == 0)
+            {
+                return (e->get_flags() & TractionDefs::CNSTFLAGS_LINKF0) != 0;
             }
-            b->data()->reset(message()->data()->mti, train_node()->node_id(),
-                             NodeHandle(dst), message()->data()->payload);
+            return (e->get_flags() & TractionDefs::CNSTFLAGS_LINKFN) != 0;
+        }
+
+        /// Reverses the direction of a forwarded speed command if the consist
+        /// member is running in reverse. @param e is the consist member,
+        /// @param m is the outgoing message to that member.
+        void maybe_flip_speed(ConsistEntry *e, GenMessage *m)
+        {
             if ((payload()[0] == TractionDefs::REQ_SET_SPEED) &&
-                (flags & TractionDefs::CNSTFLAGS_REVERSE)) {
-                b->data()->payload[1] ^= 0x80;
+                (e->get_flags() & TractionDefs::CNSTFLAGS_REVERSE))
+            {
+                m->payload[1] ^= 0x80;
             }
-            iface()->addressed_message_write_flow()->send(b);
-            ++nextConsistIndex_;
-            return call_immediately(STATE(maybe_forward_consist));
         }
 
         Action handle_traction_mgmt()
@@ -589,21 +631,118 @@ struct TrainService::Impl
     private:
         /// error code for reject_permanent().
         unsigned errorCode_ : 16;
-        unsigned nextConsistIndex_ : 8;
         /// 1 if the voluntary lock protocol has set this train to be reserved.
         unsigned reserved_ : 1;
+        /// Which shard's trains this flow is processing.
+        unsigned shard_;
+        /// Held while touching the train, nullptr if there are no shards.
+        OSMutex *lock_;
         TrainService *trainService_;
         Buffer<GenMessage> *response_;
     };
 
+    /// Traction request processing with its own thread.
+    struct Shard
+    {
+        /// Constructor. @param parent is the train service. @param index is
+        /// the shard index.
+        Shard(TrainService *parent, unsigned index)
+            : executor_(
+                  "traction_shard", 0, config_traction_shard_stack_size())
+            , service_(&executor_)
+            , traction_(parent, &service_, index, &lock_)
+        {
+        }
+
+        /// Protects the trains of this shard against other threads.
+        OSMutex lock_;
+        /// Thread running this shard.
+        Executor<1> executor_;
+        /// Service binding the flow to the shard's executor.
+        Service service_;
+        /// Processes the requests of the trains in this shard.
+        TractionRequestFlow traction_;
+    };
+
+    /// Receives all incoming traction requests from the dispatcher, and
+    /// forwards them to the traction flow of the destination train's shard.
+    class ShardRouter : public MessageHandler
+    {
+    public:
+        /// Constructor. @param parent owns the shards.
+        ShardRouter(Impl *parent)
+            : parent_(parent)
+        {
+        }
+
+        void send(Buffer<GenMessage> *message, unsigned priority) OVERRIDE
+        {
+            unsigned shard = 0;
+            {
+                AtomicHolder h(parent_->trainService_);
+                auto it = parent_->trainService_->nodes_.find(
+                    static_cast<TrainNode *>(message->data()->dstNode));
+                if (it != parent_->trainService_->nodes_.end())
+                {
+                    shard = it->second;
+                }
+            }
+            // The shard cannot touch the alias caches, so the source is
+            // resolved here, on the interface executor.
+            parent_->trainService_->iface()->canonicalize_handle(
+                &message->data()->src);
+            // Messages not for a train will be dropped by the shard.
+            parent_->shards_[shard]->traction_.send(message, priority);
+        }
+
+    private:
+        Impl *parent_;
+    };
+
+    /// Dispatcher handler for traction requests.
+    MessageHandler *handler()
+    {
+        if (shards_.empty())
+        {
+            return &traction_;
+        }
+        return &router_;
+    }
+
+    TrainService *trainService_;
+    /// Traction flow running on the interface executor. Used only when there
+    /// are no shards.
     TractionRequestFlow traction_;
+    /// Shards with their own executors. Empty if sharding is disabled.
+    std::vector<std::unique_ptr<Shard>> shards_;
+    /// Routes the incoming traction messages to the shards.
+    ShardRouter router_{this};
 };
 
-TrainService::TrainService(If *iface)
+TrainService::Impl::Impl(TrainService *parent, unsigned num_shards)
+    : trainService_(parent)
+    , traction_(parent, parent->iface(), 0, nullptr)
+{
+    for (unsigned i = 0; i < num_shards; ++i)
+    {
+        shards_.emplace_back(new Shard(parent, i));
+    }
+    parent->iface()->dispatcher()->register_handler(
+        handler(), Defs::MTI_TRACTION_CONTROL_COMMAND, 0xffff);
+}
+
+TrainService::Impl::~Impl()
+{
+    trainService_->iface()->dispatcher()->unregister_handler(
+        handler(), Defs::MTI_TRACTION_CONTROL_COMMAND, 0xffff);
+}
+
+TrainService::TrainService(If *iface, unsigned num_shards)
     : Service(iface->executor())
     , iface_(iface)
+    , numShards_(num_shards)
 {
-    impl_ = new Impl(this);
+    impl_ = new Impl(this, num_shards);
 }
 
 TrainService::~TrainService()
@@ -611,13 +750,29 @@ TrainService::~TrainService()
     delete impl_;
 }
 
+OSMutex *TrainService::train_lock(TrainNode *node)
+{
+    if (!numShards_)
+    {
+        return nullptr;
+    }
+    AtomicHolder h(this);
+    auto it = nodes_.find(node);
+    HASSERT(it != nodes_.end());
+    return &impl_->shards_[it->second]->lock_;
+}
+
 void TrainService::register_train(TrainNode *node)
 {
     iface_->add_local_node(node);
     extern void StartInitializationFlow(Node * node);
     StartInitializationFlow(node);
     AtomicHolder h(this);
-    nodes_.insert(node);
+    nodes_[node] = nextShard_;
+    if (++nextShard_ >= numShards_)
+    {
+        nextShard_ = 0;
+    }
     LOG(VERBOSE, "Registered node %p for traction.", node);
     HASSERT(nodes_.find(node) != nodes_.end());
 }
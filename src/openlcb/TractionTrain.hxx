@@ -35,12 +35,13 @@
 #ifndef _NMRANET_TRACTIONTRAIN_HXX_
 #define _NMRANET_TRACTIONTRAIN_HXX_
 
-#include <set>
+#include <map>
 
 #include "executor/Service.hxx"
 #include "openlcb/Node.hxx"
 #include "openlcb/TractionDefs.hxx"
 #include "openlcb/TrainInterface.hxx"
+#include "os/OS.hxx"
 
 namespace openlcb
 {
@@ -118,8 +119,10 @@ public:
     // calling these methods concurrently.
     //
     // In practice these methods are always called from the TractionService
-    // which only operates on a single thread (the service's executor) and will
-    // only process one request at a time. All traction protocol requests being
+    // which only operates on a single thread for any given train (the
+    // service's executor, or the executor of the shard the train is assigned
+    // to, holding TrainService::train_lock()) and will only process one
+    // request at a time. All traction protocol requests being
     // forwarded and thus traversing the consist list will be fully processed
     // before any consist change requests would reach the front of the queue
     // for the traction flow.
@@ -139,6 +142,7 @@ public:
             }
         }
         consistSlaves_.push_front(new ConsistEntry(tgt, flags));
+        ++consistLength_;
         return true;
     }
 
@@ -153,6 +157,7 @@ public:
                 auto* p = it.operator->();
                 consistSlaves_.erase(it);
                 delete p;
+                --consistLength_;
                 return true;
             }
         }
@@ -179,12 +184,23 @@ public:
     /** Returns the number of slaves in this consist. */
     int query_consist_length()
     {
-        int ret = 0;
-        for (auto it = consistSlaves_.begin(); it != consistSlaves_.end();
-             ++it, ++ret)
-        {
-        }
-        return ret;
+        return consistLength_;
+    }
+
+    /// Iterator type for walking the consist targets.
+    typedef TypedQueue<ConsistEntry>::iterator consist_iterator;
+
+    /** @return iterator pointing to the first consist target. Together with
+     * consist_end() this allows visiting all targets in a single pass. */
+    consist_iterator consist_begin()
+    {
+        return consistSlaves_.begin();
+    }
+
+    /** @return sentinel for the end of the consist target list. */
+    SimpleQueue::end_iterator consist_end()
+    {
+        return consistSlaves_.end();
     }
 
 protected:
@@ -196,6 +212,8 @@ private:
 
     /// Controller node that is assigned to run this train. 0 if none.
     NodeHandle controllerNodeId_;
+    /// Number of entries in consistSlaves_.
+    unsigned consistLength_{0};
     TypedQueue<ConsistEntry> consistSlaves_;
 };
 
@@ -230,7 +248,16 @@ private:
 class TrainService : public Service, private Atomic
 {
 public:
-    TrainService(If *iface);
+    /// Constructor.
+    ///
+    /// @param iface is the OpenLCB interface the trains live on.
+    /// @param num_shards if zero, all traction requests are processed on the
+    /// interface's executor. Otherwise the trains are distributed among this
+    /// many shards, each with its own executor thread and traction request
+    /// flow, and incoming traction messages are routed to the shard of the
+    /// destination train. Useful for proxies hosting a large number of
+    /// trains.
+    TrainService(If *iface, unsigned num_shards = 0);
     ~TrainService();
 
     If *iface()
@@ -242,14 +269,69 @@ public:
         initialization flow for the train. */
     void register_train(TrainNode *node);
 
+    /// @return the number of traction shards, or zero if the traction
+    /// requests are processed on the interface executor.
+    unsigned num_shards()
+    {
+        return numShards_;
+    }
+
+    /// @return the lock protecting a train node and its TrainImpl, or nullptr
+    /// if there are no shards. A shard holds the lock of its trains while
+    /// processing a request. Any other thread touching the train, including
+    /// the interface executor, has to hold it too. @param node a train
+    /// registered with this service.
+    OSMutex *train_lock(TrainNode *node);
+
+    /// Holds the lock of a train (see train_lock()) while in scope.
+    class TrainLock
+    {
+    public:
+        /// Constructor. @param service the train service. @param node a train
+        /// registered with the service.
+        TrainLock(TrainService *service, TrainNode *node)
+            : TrainLock(service->train_lock(node))
+        {
+        }
+
+        /// Constructor. @param lock lock to hold, or nullptr for none.
+        TrainLock(OSMutex *lock)
+            : lock_(lock)
+        {
+            if (lock_)
+            {
+                lock_->lock();
+            }
+        }
+
+        ~TrainLock()
+        {
+            if (lock_)
+            {
+                lock_->unlock();
+            }
+        }
+
+    private:
+        /// The lock we hold, or nullptr.
+        OSMutex *lock_;
+
+        DISALLOW_COPY_AND_ASSIGN(TrainLock);
+    };
+
 private:
     struct Impl;
     /** Implementation flows. */
     Impl *impl_;
 
     If *iface_;
-    /** List of train nodes managed by this Service. */
-    std::set<TrainNode *> nodes_;
+    /** Train nodes managed by this Service, mapped to the shard index they
+     * were assigned to. */
+    std::map<TrainNode *, unsigned> nodes_;
+    /** How many shards the trains are distributed among. */
+    unsigned numShards_;
+    /** Shard to assign the next registered train to. */
+    unsigned nextShard_{0};
 };
 
 } // namespace openlcb
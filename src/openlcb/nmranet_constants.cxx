@@ -59,7 +59,33 @@ DEFAULT_CONST(num_memory_spaces, 5);
  * because there is no protection against segfaults in it. */
 DEFAULT_CONST_FALSE(enable_all_memory_space);
 
+/** Set to CONSTANT_TRUE if you want the SimpleStack to export the CDI in
+ * compressed form in an additional memory space (0xF7). This makes reading
+ * the CDI many times faster for clients that support it. */
+DEFAULT_CONST_FALSE(enable_compressed_cdi_space);
+
+/** Largest number of bytes of the config file the ConfigUpdateFlow reads into
+ * RAM at once while calling the config update listeners. Listeners whose
+ * config is outside of this window read the file directly. */
+DEFAULT_CONST(config_update_cache_size, 1024);
+
 /** Set to CONSTANT_TRUE if you want the nodes to send out producer / consumer
  * identified messages at boot time. This is required by the OpenLCB
  * standard. */
 DEFAULT_CONST_TRUE(node_init_identify);
+
+/** Average CAN frame rate that the initialization of virtual nodes may use.
+ * Nodes are started slower when many are initialized at once. 0 means no
+ * limit. */
+DEFAULT_CONST(node_init_frames_per_sec, 0);
+
+/** Estimated number of frames the initialization of a virtual node sends, for
+ * the node_init_frames_per_sec rate limit. */
+DEFAULT_CONST(node_init_frames_per_node, 8);
+
+/** How many frames the node initialization may send at once after the bus was
+ * idle, when node_init_frames_per_sec is set. */
+DEFAULT_CONST(node_init_frame_burst, 64);
+
+/** Stack size in bytes of the executor threads of a sharded TrainService. */
+DEFAULT_CONST(traction_shard_stack_size, 2048);
@@ -98,6 +98,21 @@ public:
     /// @param fd is the file descriptor for the EEPROM file. The current
     /// offset in this file is unspecified, callees must do lseek.
     virtual void factory_reset(int fd) = 0;
+
+    /// Reports which part of the configuration file apply_configuration
+    /// reads. Configuration updates that did not modify this range will not
+    /// call this component.
+    ///
+    /// @param offset will be set to the first byte of the range.
+    /// @param size will be set to the number of bytes in the range.
+    ///
+    /// @return false if the component depends on arbitrary parts of the
+    /// configuration (this is the default); such components are called upon
+    /// every update.
+    virtual bool config_extent(unsigned *offset, unsigned *size)
+    {
+        return false;
+    }
 };
 
 
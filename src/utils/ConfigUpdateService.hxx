@@ -60,7 +60,34 @@ public:
     virtual void unregister_update_listener(ConfigUpdateListener *listener) = 0;
 
     /// Executes an update in response to the configuration having changed.
+    /// Calls all listeners.
     virtual void trigger_update() = 0;
+
+    /// Executes an update in response to the ranges recorded with
+    /// mark_dirty() having changed. Only calls the listeners whose
+    /// config_extent overlaps a modified range, or all listeners if nothing
+    /// was recorded.
+    virtual void trigger_dirty_update()
+    {
+        trigger_update();
+    }
+
+    /// Records that a range of the configuration file was modified, for the
+    /// next trigger_dirty_update().
+    ///
+    /// @param offset is the first modified byte.
+    /// @param size is the number of modified bytes.
+    virtual void mark_dirty(unsigned offset, unsigned size)
+    {
+    }
+
+    /// @return a number that changes every time mark_dirty() is called. Lets
+    /// caches of data in the config file notice a write before the update is
+    /// triggered.
+    virtual unsigned write_count()
+    {
+        return 0;
+    }
 };
 
 #endif // _UTILS_CONFIGUPDATESERVICE_HXX_
@@ -270,3 +270,64 @@ TEST_F(EepromTest, many_overflow) {
     }
     EXPECT_AT(13, "abcd");
 }
+
+TEST_F(EepromTest, index_after_overflow) {
+    create();
+    write_to(0, "0123456789");
+    write_to(990, "abcdefghij");
+    for (int i = 0; i < 5; ++i) {
+        overflow_block();
+        write_to(4, "xy");
+    }
+    EXPECT_AT(0, "0123xy6789");
+    EXPECT_AT(990, "abcdefghij");
+    create(false);
+    EXPECT_AT(0, "0123xy6789");
+    EXPECT_AT(990, "abcdefghij");
+    EXPECT_AT(500, "\xFF\xFF\xFF");
+}
+
+/// Fills the eeprom under test with a journal that has every block written
+/// and the active sector about half full.
+static void fill_journal(EEPROM *ee) {
+    string payload(EepromTest::eeprom_size, 0);
+    for (unsigned i = 0; i < payload.size(); ++i) {
+        payload[i] = i & 0xff;
+    }
+    ee->write(0, payload.data(), payload.size());
+}
+
+TEST_F(EepromTest, benchmark_read) {
+    create();
+    fill_journal(ee());
+    static constexpr unsigned kChunk = 16;
+    static constexpr unsigned kRounds = 20;
+    uint8_t buf[kChunk];
+    long long start = os_get_time_monotonic();
+    for (unsigned r = 0; r < kRounds; ++r) {
+        for (unsigned ofs = 0; ofs + kChunk <= eeprom_size; ofs += kChunk) {
+            ee()->read(ofs, buf, kChunk);
+        }
+    }
+    long long elapsed = os_get_time_monotonic() - start;
+    unsigned reads = kRounds * (eeprom_size / kChunk);
+    LOG(INFO, "eeprom read benchmark (shadow %d index %d): %u reads of %u "
+        "bytes, %lld nsec per read", EEPROMEmulation::SHADOW_IN_RAM,
+        EEPROMEmulation::INDEX_IN_RAM, reads, kChunk, elapsed / reads);
+    EXPECT_EQ(((eeprom_size / kChunk - 1) * kChunk) & 0xff, buf[0]);
+}
+
+TEST_F(EepromTest, benchmark_mount) {
+    create();
+    fill_journal(ee());
+    static constexpr unsigned kRounds = 20;
+    long long start = os_get_time_monotonic();
+    for (unsigned r = 0; r < kRounds; ++r) {
+        create(false);
+    }
+    long long elapsed = os_get_time_monotonic() - start;
+    LOG(INFO, "eeprom mount benchmark (shadow %d index %d): %lld nsec per "
+        "mount", EEPROMEmulation::SHADOW_IN_RAM,
+        EEPROMEmulation::INDEX_IN_RAM, elapsed / kRounds);
+    EXPECT_AT(100, "\x64\x65\x66");
+}
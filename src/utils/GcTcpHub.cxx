@@ -39,11 +39,24 @@
 
 void GcTcpHub::OnNewConnection(int fd)
 {
-    create_gc_port_for_can_hub(canHub_, fd);
+    if (hasLimits_)
+    {
+        create_limited_gc_port_for_can_hub(
+            canHub_, fd, nullptr, limits_, useSelect_);
+    }
+    else if (useSelect_)
+    {
+        create_gc_port_for_can_hub_select(canHub_, fd);
+    }
+    else
+    {
+        create_gc_port_for_can_hub(canHub_, fd);
+    }
 }
 
-GcTcpHub::GcTcpHub(CanHubFlow *can_hub, int port)
+GcTcpHub::GcTcpHub(CanHubFlow *can_hub, int port, bool use_select)
     : canHub_(can_hub)
+    , useSelect_(use_select)
     , tcpListener_(port, std::bind(&GcTcpHub::OnNewConnection, this,
                                    std::placeholders::_1))
 {
@@ -36,6 +36,7 @@
 
 #include "utils/socket_listener.hxx"
 #include "utils/Hub.hxx"
+#include "utils/LimitedHubPort.hxx"
 
 class ExecutorBase;
 
@@ -51,7 +52,10 @@ public:
     /// @param can_hub Which CAN-hub should we attach the TCP gridconnect hub
     /// onto.
     /// @param port TCp port number to listen on.
-    GcTcpHub(CanHubFlow *can_hub, int port);
+    /// @param use_select if true, the client connections are served from the
+    /// executor of the hub using select; otherwise each connection gets a
+    /// read thread and a write thread.
+    GcTcpHub(CanHubFlow *can_hub, int port, bool use_select = false);
     ~GcTcpHub();
 
     /// @return true of the listener is ready to accept incoming connections.
@@ -60,6 +64,20 @@ public:
         return tcpListener_.is_started();
     }
 
+    /// Bounds how much data may be waiting to be sent to each client. Without
+    /// this, a client that stopped reading makes the process queue up every
+    /// packet on the bus for it. Applies to the connections accepted after
+    /// the call; call it before any client connects.
+    ///
+    /// @param limits are the limits of each client's write queue, in
+    /// gridconnect packets and bytes, and the policy when they are exceeded.
+    /// With the DISCONNECT policy the client is disconnected.
+    void set_client_limits(const LimitedHubPortBase::Limits &limits)
+    {
+        limits_ = limits;
+        hasLimits_ = true;
+    }
+
 private:
     /// Callback when a new connection arrives.
     ///
@@ -70,6 +88,12 @@ private:
     /// @param can_hub Which CAN-hub should we attach the TCP gridconnect hub
     /// onto.
     CanHubFlow *canHub_;
+    /// True if the connections should be served by select on the executor.
+    bool useSelect_;
+    /// True if the client write queues are limited.
+    bool hasLimits_{false};
+    /// Limits of the client write queues if hasLimits_ is set.
+    LimitedHubPortBase::Limits limits_;
     /// Helper object representing the listening on the socket.
     SocketListener tcpListener_;
 };
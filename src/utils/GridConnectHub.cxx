@@ -41,6 +41,7 @@
 #include "utils/Buffer.hxx"
 #include "utils/BufferPort.hxx"
 #include "utils/HubDevice.hxx"
+#include "utils/HubDeviceSelect.hxx"
 #include "utils/Hub.hxx"
 #include "utils/GcStreamParser.hxx"
 #include "utils/gc_format.h"
@@ -373,7 +374,11 @@ GcPacketPrinter::~GcPacketPrinter()
 ///
 /// Sends a notification to the application level when there is an error on the
 /// device and the connection is closed.
-struct GcHubPort : public Executable
+///
+/// @param Port is the class doing the device IO: FdHubPort<HubFlow> uses a
+/// read thread and a write thread, HubDeviceSelect<HubFlow> runs on the
+/// executor of the hub.
+template <class Port> struct GcHubPort : public Executable
 {
     /// Constructor.
     ///
@@ -390,6 +395,24 @@ struct GcHubPort : public Executable
     {
         LOG(VERBOSE, "gchub port %p", (Executable *)this);
     }
+
+    /// Constructor with a limited write queue.
+    ///
+    /// @param can_hub Parent (binary) hub flow.
+    /// @param fd device descriptor of open channel (device or socket)
+    /// @param on_exit Notifiable that will be called when the descriptor
+    /// experiences an error (typically upon device closed or connection lost).
+    /// @param limits are the limits of the write queue towards the fd.
+    GcHubPort(CanHubFlow *can_hub, int fd, Notifiable *on_exit,
+        const LimitedHubPortBase::Limits &limits)
+        : gcHub_(can_hub->service())
+        , bridge_(
+              GCAdapterBase::CreateGridConnectAdapter(&gcHub_, can_hub, false))
+        , gcWrite_(&gcHub_, fd, this, limits)
+        , onExit_(on_exit)
+    {
+        LOG(VERBOSE, "limited gchub port %p", (Executable *)this);
+    }
     virtual ~GcHubPort()
     {
     }
@@ -410,7 +433,7 @@ struct GcHubPort : public Executable
     /** Reads the characters from the char-hub and sends them to the
      * fd. Similarly, listens to the fd and sends the read charcters to the
      * char-hub. */
-    FdHubPort<HubFlow> gcWrite_;
+    Port gcWrite_;
     /** If not null, this notifiable will be called when the device is
      * closed. */
     Notifiable* onExit_;
@@ -449,5 +472,25 @@ struct GcHubPort : public Executable
 
 void create_gc_port_for_can_hub(CanHubFlow *can_hub, int fd, Notifiable* on_exit)
 {
-    new GcHubPort(can_hub, fd, on_exit);
+    new GcHubPort<FdHubPort<HubFlow>>(can_hub, fd, on_exit);
+}
+
+void create_gc_port_for_can_hub_select(
+    CanHubFlow *can_hub, int fd, Notifiable *on_exit)
+{
+    new GcHubPort<HubDeviceSelect<HubFlow>>(can_hub, fd, on_exit);
+}
+
+void create_limited_gc_port_for_can_hub(CanHubFlow *can_hub, int fd,
+    Notifiable *on_exit, const LimitedHubPortBase::Limits &limits,
+    bool use_select)
+{
+    if (use_select)
+    {
+        new GcHubPort<HubDeviceSelect<HubFlow>>(can_hub, fd, on_exit, limits);
+    }
+    else
+    {
+        new GcHubPort<FdHubPort<HubFlow>>(can_hub, fd, on_exit, limits);
+    }
 }
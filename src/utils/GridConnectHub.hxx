@@ -37,6 +37,7 @@
 #include <memory>
 
 #include "utils/Hub.hxx"
+#include "utils/LimitedHubPort.hxx"
 
 class Pipe;
 template <class T> class FlowInterface;
@@ -135,4 +136,35 @@ private:
  * an error is encountered on this port and the port is subsequently closed. */
 void create_gc_port_for_can_hub(CanHubFlow* can_hub, int fd, Notifiable* on_exit = nullptr);
 
+/** Creates a new port on a CAN hub in gridconnect format, which performs all
+ * IO on the executor of the hub using select, without starting any
+ * threads. The fd will be set to non-blocking mode. Otherwise the same as
+ * create_gc_port_for_can_hub.
+ *
+ * @param can_hub the raw CAN packets are coming/going to this object.
+ * @param fd the file descriptor of the port to send/receive the gridconnect
+ * ascii data to/from.
+ * @param on_exit is a notificable (may be null) which will be called in case
+ * an error is encountered on this port and the port is subsequently closed. */
+void create_gc_port_for_can_hub_select(
+    CanHubFlow *can_hub, int fd, Notifiable *on_exit = nullptr);
+
+/** Creates a new port on a CAN hub in gridconnect format, bounding how much
+ * gridconnect data may be waiting to be written to the fd. Otherwise the
+ * same as create_gc_port_for_can_hub (or create_gc_port_for_can_hub_select).
+ *
+ * @param can_hub the raw CAN packets are coming/going to this object.
+ * @param fd the file descriptor of the port to send/receive the gridconnect
+ * ascii data to/from.
+ * @param on_exit is a notificable (may be null) which will be called in case
+ * an error is encountered on this port and the port is subsequently closed.
+ * @param limits are the limits of the write queue, in gridconnect packets
+ * and bytes, and the policy when they are exceeded. With the DISCONNECT
+ * policy the port is closed.
+ * @param use_select if true, all IO is performed on the executor of the
+ * hub. */
+void create_limited_gc_port_for_can_hub(CanHubFlow *can_hub, int fd,
+    Notifiable *on_exit, const LimitedHubPortBase::Limits &limits,
+    bool use_select = false);
+
 #endif //_UTILS_GRIDCONNECTHUB_HXX_
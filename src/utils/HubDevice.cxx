@@ -53,7 +53,7 @@ void FdHubPort<CanHubFlow>::ReadThread::send_message(const void *buf, int size)
 {
     HASSERT(size == sizeof(struct can_frame));
     auto *b = port()->hub_->alloc();
-    b->data()->skipMember_ = &port()->writeFlow_;
+    b->data()->skipMember_ = port()->registered_port();
     memcpy(b->data()->mutable_frame(), buf, size);
     port()->hub_->send(b, 0);
 }
@@ -85,7 +85,7 @@ void FdHubPort<HubFlow>::ReadThread::send_message(const void *buf, int size)
     {
         b->set_done(done);
     }
-    b->data()->skipMember_ = &port()->writeFlow_;
+    b->data()->skipMember_ = port()->registered_port();
     b->data()->assign((const char *)buf, size);
     port()->hub_->send(b);
 }
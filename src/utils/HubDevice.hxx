@@ -36,7 +36,10 @@
 
 #include <unistd.h>
 
+#include <memory>
+
 #include "utils/Hub.hxx"
+#include "utils/LimitedHubPort.hxx"
 #include "executor/SemaphoreNotifiableBlock.hxx"
 
 template <class Data> class FdHubWriteFlow;
@@ -114,6 +117,11 @@ protected:
             else
             {
                 hasError_ = 1;
+#if defined(__linux__) || defined(__MACH__)
+                // Wakes up a write thread blocked on a socket whose peer
+                // stopped reading. Fails harmlessly on non-sockets.
+                ::shutdown(fd_, SHUT_RDWR);
+#endif
                 ::close(fd_);
             }
         }
@@ -298,14 +306,60 @@ public:
         hub_->register_port(&writeFlow_);
     }
 
+    /// Constructor that bounds how much data may be waiting to be written to
+    /// the fd. A LimitedHubPort is registered with the hub in front of the
+    /// write flow. When the DISCONNECT policy triggers, the port is closed
+    /// as if there was an IO error.
+    ///
+    /// @param hub Parent hub where to register *this.
+    /// @param fd file descriptor to read/write
+    /// @param done will be notified when the termination of the port is
+    /// completed.
+    /// @param limits are the write queue limits and policy.
+    FdHubPort(HFlow *hub, int fd, Notifiable *done,
+        const LimitedHubPortBase::Limits &limits)
+        : FdHubPortBase(fd, done)
+        , hub_(hub)
+        , writeFlow_(this)
+        , limiter_(new LimitedHubPort<HFlow>(
+              hub, &writeFlow_, limits, &limitDisconnect_))
+        , readThread_(this)
+    {
+    }
+
     ~FdHubPort() OVERRIDE
     {
         writeThread_.shutdown();
     }
 
+    /// @return the port that is registered with the hub (the limiter if
+    /// there is one); incoming data skips this port.
+    typename HFlow::port_type *registered_port()
+    {
+        if (limiter_)
+        {
+            return limiter_.get();
+        }
+        return &writeFlow_;
+    }
+
+    /// @return the write queue limiter, or nullptr if this port is
+    /// unlimited.
+    LimitedHubPort<HFlow> *limiter()
+    {
+        return limiter_.get();
+    }
+
     void unregister_write_port() OVERRIDE
     {
-        hub_->unregister_port(&writeFlow_);
+        if (limiter_)
+        {
+            limiter_->unregister();
+        }
+        else
+        {
+            hub_->unregister_port(&writeFlow_);
+        }
         /* We put an empty message at the end of the queue. This will cause
          * wait until all pending messages are dealt with, and then ping the
          * barrier notifiable, commencing the shutdown. */
@@ -366,10 +420,34 @@ public:
 private:
     friend class ReadThread;
 
+    /// Closes the port when the write queue limiter disconnects.
+    class LimitDisconnect : public Notifiable
+    {
+    public:
+        /// Constructor. @param port is the parent.
+        LimitDisconnect(FdHubPort *port)
+            : port_(port)
+        {
+        }
+
+        void notify() OVERRIDE
+        {
+            port_->report_error();
+        }
+
+    private:
+        /// Parent port.
+        FdHubPort *port_;
+    };
+
     /// Parent hub to send the data to / read the data from.
     HFlow *hub_;
     /// StateFlow that is performing the actual writes.
     FdHubWriteFlow<typename HFlow::value_type> writeFlow_;
+    /// Notified by the limiter when it disconnected.
+    LimitDisconnect limitDisconnect_{this};
+    /// Bounds the write queue. nullptr if unlimited.
+    std::unique_ptr<LimitedHubPort<HFlow>> limiter_;
     /// An OSThread child that is performing the reads.
     ReadThread readThread_;
 };
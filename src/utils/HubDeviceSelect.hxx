@@ -34,6 +34,7 @@
 #ifndef _UTILS_HUBDEVICESELECT_HXX_
 #define _UTILS_HUBDEVICESELECT_HXX_
 
+#include <memory>
 #include <unistd.h>
 #include <stdio.h>
 #include <fcntl.h>
@@ -41,6 +42,7 @@
 #include "executor/StateFlow.hxx"
 #include "freertos/can_ioctl.h"
 #include "utils/Hub.hxx"
+#include "utils/LimitedHubPort.hxx"
 
 /// Generic template for the buffer traits. HubDeviceSelect will not compile on
 /// this default template because it lacks the necessary definitions. For each
@@ -151,8 +153,8 @@ public:
         , fd_(::open(path, O_RDWR | O_NONBLOCK))
         , barrier_(on_error ? on_error : EmptyNotifiable::DefaultInstance())
         , hub_(hub)
-        , readFlow_(this)
         , writeFlow_(this)
+        , readFlow_(this)
     {
         HASSERT(fd_ >= 0);
         barrier_.new_child();
@@ -172,8 +174,8 @@ public:
         , fd_(fd)
         , barrier_(on_error ? on_error : EmptyNotifiable::DefaultInstance())
         , hub_(hub)
-        , readFlow_(this)
         , writeFlow_(this)
+        , readFlow_(this)
     {
         HASSERT(fd_ >= 0);
         barrier_.new_child();
@@ -186,6 +188,38 @@ public:
         hub_->register_port(write_port());
     }
 
+    /// Creates a select-aware hub port for the opened device specified by
+    /// `fd', bounding how much data may be waiting to be written to it. A
+    /// LimitedHubPort is registered with the hub in front of the write
+    /// flow. When the DISCONNECT policy triggers, the port is closed as if
+    /// there was a write error.
+    ///
+    /// @param hub the hub to open the port on
+    /// @param fd the filedes to read/write data from/to.
+    /// @param on_error notifiable that will be called when a write or read
+    /// error is encountered.
+    /// @param limits are the write queue limits and policy.
+    HubDeviceSelect(HFlow *hub, int fd, Notifiable *on_error,
+        const LimitedHubPortBase::Limits &limits)
+        : Service(hub->service()->executor())
+        , fd_(fd)
+        , barrier_(on_error ? on_error : EmptyNotifiable::DefaultInstance())
+        , hub_(hub)
+        , writeFlow_(this)
+        , limiter_(new LimitedHubPort<HFlow>(
+              hub, &writeFlow_, limits, &limitDisconnect_))
+        , readFlow_(this)
+    {
+        HASSERT(fd_ >= 0);
+        barrier_.new_child();
+#ifdef __WINNT__
+        unsigned long par = 1;
+        ioctlsocket(fd_, FIONBIO, &par);
+#else
+        ::fcntl(fd, F_SETFL, O_RDWR | O_NONBLOCK);
+#endif
+    }
+
     virtual ~HubDeviceSelect()
     {
         if (fd_ >= 0) {
@@ -221,6 +255,24 @@ public:
         return &writeFlow_;
     }
 
+    /// @return the port that is registered with the hub (the limiter if
+    /// there is one); incoming data skips this port.
+    typename HFlow::port_type *registered_port()
+    {
+        if (limiter_)
+        {
+            return limiter_.get();
+        }
+        return &writeFlow_;
+    }
+
+    /// @return the write queue limiter, or nullptr if this port is
+    /// unlimited.
+    LimitedHubPort<HFlow> *limiter()
+    {
+        return limiter_.get();
+    }
+
     /// @return filedes to write to / read from.
     int fd()
     {
@@ -230,7 +282,14 @@ public:
     /// Removes the current write port from the registry of the source hub.
     void unregister_write_port()
     {
-        hub_->unregister_port(&writeFlow_);
+        if (limiter_)
+        {
+            limiter_->unregister();
+        }
+        else
+        {
+            hub_->unregister_port(&writeFlow_);
+        }
         /* We put an empty message at the end of the queue. This will cause
          * wait until all pending messages are dealt with, and then ping the
          * barrier notifiable, commencing the shutdown. */
@@ -285,7 +344,7 @@ protected:
         Action try_read()
         {
             b_ = this->get_allocation_result(device()->hub());
-            b_->data()->skipMember_ = device()->write_port();
+            b_->data()->skipMember_ = device()->registered_port();
             SelectBufferInfo<buffer_type>::resize_target(b_);
             if (SelectBufferInfo<buffer_type>::needs_read_fully())
             {
@@ -430,11 +489,49 @@ protected:
     BarrierNotifiable barrier_;
     /// Hub whose data we are trying to send.
     HFlow *hub_;
-    /// StateFlow for reading data from the fd. Woken when data arrives.
-    ReadFlow readFlow_;
+    /// Closes the device when the write queue limiter disconnects. The
+    /// limiter calls this from the hub, which runs on our executor.
+    class LimitDisconnect : public Notifiable
+    {
+    public:
+        /// Constructor. @param device is the parent.
+        LimitDisconnect(HubDeviceSelect *device)
+            : device_(device)
+        {
+        }
+
+        void notify() OVERRIDE
+        {
+            if (device_->fd_ < 0)
+            {
+                return;
+            }
+            device_->unregister_write_port();
+            // The write flow is typically waiting for the fd to become
+            // writable, so it has to be unselected like in the destructor.
+            int fd = device_->fd_;
+            device_->fd_ = -1;
+            device_->readFlow_.shutdown();
+            device_->writeFlow_.shutdown();
+            ::close(fd);
+        }
+
+    private:
+        /// Parent device.
+        HubDeviceSelect *device_;
+    };
+
     /// StateFlow for writing data to the fd. Woken by data to send or the fd
     /// being writeable.
     WriteFlow writeFlow_;
+    /// Notified by the limiter when it disconnected.
+    LimitDisconnect limitDisconnect_{this};
+    /// Bounds the write queue. nullptr if unlimited.
+    std::unique_ptr<LimitedHubPort<HFlow>> limiter_;
+    /// StateFlow for reading data from the fd. Woken when data arrives. Has
+    /// to come after the limiter, because it starts reading right away and
+    /// looks at registered_port().
+    ReadFlow readFlow_;
 };
 
 #endif // _UTILS_HUBDEVICESELECT_HXX_
@@ -0,0 +1,390 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file LimitedHubPort.hxx
+ *
+ * Hub port wrapper that bounds the amount of data queued for a slow port.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _UTILS_LIMITEDHUBPORT_HXX_
+#define _UTILS_LIMITEDHUBPORT_HXX_
+
+#include "executor/Notifiable.hxx"
+#include "utils/Atomic.hxx"
+#include "utils/Hub.hxx"
+#include "utils/Queue.hxx"
+
+/// Non-templated parts of LimitedHubPort.
+class LimitedHubPortBase
+{
+public:
+    /// What to do when the limits of the queue are exceeded.
+    enum Policy
+    {
+        /// Discards the oldest queued messages to make room.
+        DROP_OLDEST,
+        /// Discards the incoming message.
+        DROP_NEWEST,
+        /// Discards everything queued, unregisters from the hub and notifies
+        /// the on_disconnect callback. The owner is expected to close the
+        /// port.
+        DISCONNECT
+    };
+
+    /// Limits and policy of a LimitedHubPort, for code that creates the
+    /// limited ports on behalf of the application (such as GcTcpHub).
+    struct Limits
+    {
+        /// How many messages may be queued (not counting the ones in
+        /// flight). 0 for unlimited.
+        unsigned maxFrames{0};
+        /// How many bytes of payload may be queued. 0 for unlimited.
+        size_t maxBytes{0};
+        /// What to do when a limit is exceeded.
+        Policy policy{DROP_OLDEST};
+    };
+};
+
+/// Sits between a hub and one of its ports, and bounds how much data may be
+/// waiting for that port. Without this, a port that stopped consuming (e.g. a
+/// TCP client that went to sleep) keeps accumulating buffers until the whole
+/// process runs out of memory.
+///
+/// Usage: instead of registering the port with the hub, create a
+/// LimitedHubPort with the hub and the port. The LimitedHubPort registers
+/// itself with the hub, and forwards at most MAX_IN_FLIGHT buffers at a time
+/// to the port. Further messages are queued here, subject to the frame and
+/// byte limits. When a limit is exceeded, the policy decides what happens.
+///
+/// The object must not be destroyed while the port is still holding on to
+/// buffers forwarded to it.
+template <class HFlow>
+class LimitedHubPort : public HFlow::port_type,
+                       public LimitedHubPortBase,
+                       private Atomic
+{
+public:
+    /// Buffer type of the hub.
+    typedef typename HFlow::buffer_type buffer_type;
+    /// Base type of the hub's ports.
+    typedef typename HFlow::port_type port_type;
+
+    /// How many buffers the port may be processing at the same time.
+    static constexpr unsigned MAX_IN_FLIGHT = 2;
+
+    /// Constructor.
+    ///
+    /// @param hub the hub to register with.
+    /// @param port the port to forward the messages to.
+    /// @param max_frames how many messages may be queued (not counting the
+    /// ones in flight). 0 for unlimited.
+    /// @param max_bytes how many bytes of payload may be queued. 0 for
+    /// unlimited.
+    /// @param policy what to do when a limit is exceeded.
+    /// @param on_disconnect will be notified when the DISCONNECT policy is
+    /// triggered. May be nullptr.
+    LimitedHubPort(HFlow *hub, port_type *port, unsigned max_frames,
+        size_t max_bytes, Policy policy, Notifiable *on_disconnect = nullptr)
+        : hub_(hub)
+        , port_(port)
+        , maxFrames_(max_frames)
+        , maxBytes_(max_bytes)
+        , policy_(policy)
+        , onDisconnect_(on_disconnect)
+    {
+        for (auto &s : slots_)
+        {
+            s.parent_ = this;
+        }
+        hub_->register_port(this);
+    }
+
+    /// Constructor. @param hub the hub to register with. @param port the
+    /// port to forward the messages to. @param limits are the queue limits
+    /// and policy. @param on_disconnect will be notified when the DISCONNECT
+    /// policy is triggered. May be nullptr.
+    LimitedHubPort(HFlow *hub, port_type *port, const Limits &limits,
+        Notifiable *on_disconnect = nullptr)
+        : LimitedHubPort(hub, port, limits.maxFrames, limits.maxBytes,
+              limits.policy, on_disconnect)
+    {
+    }
+
+    ~LimitedHubPort()
+    {
+        unregister();
+        AtomicHolder h(this);
+        for (auto &s : slots_)
+        {
+            HASSERT(!s.busy_);
+        }
+        clear_queue();
+    }
+
+    /// Entry point from the hub. @param b the message to forward. @param
+    /// priority is ignored.
+    void send(buffer_type *b, unsigned priority = UINT_MAX) OVERRIDE
+    {
+        Slot *slot = nullptr;
+        bool disconnect = false;
+        {
+            AtomicHolder h(this);
+            if (disconnected_)
+            {
+                ++droppedFrames_;
+                droppedBytes_ += b->data()->size();
+                b->unref();
+                return;
+            }
+            slot = free_slot();
+            if (!slot)
+            {
+                size_t sz = b->data()->size();
+                while (over_limit(sz) && queue_.size())
+                {
+                    if (policy_ == DROP_OLDEST)
+                    {
+                        drop(static_cast<buffer_type *>(queue_.next(0)));
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+                if (over_limit(sz))
+                {
+                    ++droppedFrames_;
+                    droppedBytes_ += sz;
+                    b->unref();
+                    if (policy_ == DISCONNECT)
+                    {
+                        disconnected_ = true;
+                        clear_queue();
+                        disconnect = true;
+                    }
+                    else
+                    {
+                        return;
+                    }
+                }
+                else
+                {
+                    queue_.insert(b, 0);
+                    queuedBytes_ += sz;
+                    return;
+                }
+            }
+        }
+        if (disconnect)
+        {
+            hub_->unregister_port(this);
+            if (onDisconnect_)
+            {
+                onDisconnect_->notify();
+            }
+            return;
+        }
+        forward(slot, b);
+    }
+
+    /// Unregisters from the hub and discards the queued messages. Messages
+    /// already forwarded to the port are not affected. Used by the owner
+    /// when the port is being closed. Does nothing if already unregistered.
+    void unregister()
+    {
+        {
+            AtomicHolder h(this);
+            if (disconnected_)
+            {
+                return;
+            }
+            disconnected_ = true;
+            clear_queue();
+        }
+        hub_->unregister_port(this);
+    }
+
+    /// @return how many messages were dropped due to the limits.
+    unsigned dropped_frames()
+    {
+        return droppedFrames_;
+    }
+
+    /// @return how many bytes of payload were dropped due to the limits.
+    size_t dropped_bytes()
+    {
+        return droppedBytes_;
+    }
+
+    /// @return how many messages are waiting in the queue.
+    unsigned queued_frames()
+    {
+        AtomicHolder h(this);
+        return queue_.size();
+    }
+
+    /// @return how many bytes of payload are waiting in the queue.
+    size_t queued_bytes()
+    {
+        return queuedBytes_;
+    }
+
+    /// @return true if the DISCONNECT policy was triggered or the port was
+    /// unregistered.
+    bool is_disconnected()
+    {
+        return disconnected_;
+    }
+
+private:
+    /// Tracks one buffer handed over to the port.
+    struct Slot : public Notifiable
+    {
+        /// Called when the port released the buffer.
+        void notify() OVERRIDE
+        {
+            parent_->slot_done(this);
+        }
+
+        /// Owning object.
+        LimitedHubPort *parent_;
+        /// Set as the done notifiable of the buffer in flight.
+        BarrierNotifiable barrier_;
+        /// Done notifiable of the original sender of the buffer in flight.
+        BarrierNotifiable *upstreamDone_{nullptr};
+        /// True while a buffer is in flight in this slot.
+        bool busy_{false};
+    };
+
+    /// @return a slot that is not busy and marks it busy, or nullptr if all
+    /// slots are busy. Must be called locked.
+    Slot *free_slot()
+    {
+        for (auto &s : slots_)
+        {
+            if (!s.busy_)
+            {
+                s.busy_ = true;
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @return true if queueing an additional message would exceed the
+    /// limits. @param sz payload size of the additional message.
+    bool over_limit(size_t sz)
+    {
+        return (maxFrames_ && queue_.size() + 1 > maxFrames_) ||
+            (maxBytes_ && queuedBytes_ + sz > maxBytes_);
+    }
+
+    /// Discards a queued message. Must be called locked. @param b the
+    /// message.
+    void drop(buffer_type *b)
+    {
+        size_t sz = b->data()->size();
+        queuedBytes_ -= sz;
+        ++droppedFrames_;
+        droppedBytes_ += sz;
+        b->unref();
+    }
+
+    /// Discards all queued messages. Must be called locked.
+    void clear_queue()
+    {
+        while (queue_.size())
+        {
+            drop(static_cast<buffer_type *>(queue_.next(0)));
+        }
+    }
+
+    /// Sends a message to the port, taking over its done notification.
+    /// @param slot tracks the message. @param b the message.
+    void forward(Slot *slot, buffer_type *b)
+    {
+        // Keeps the original done notifiable pending until the port is
+        // actually finished with the buffer.
+        slot->upstreamDone_ = b->new_child();
+        b->set_done(slot->barrier_.reset(slot));
+        port_->send(b);
+    }
+
+    /// Called when the port finished with the buffer of a slot. @param slot
+    /// the slot that became free.
+    void slot_done(Slot *slot)
+    {
+        if (slot->upstreamDone_)
+        {
+            slot->upstreamDone_->notify();
+            slot->upstreamDone_ = nullptr;
+        }
+        buffer_type *b;
+        {
+            AtomicHolder h(this);
+            b = static_cast<buffer_type *>(queue_.next(0));
+            if (!b)
+            {
+                slot->busy_ = false;
+                return;
+            }
+            queuedBytes_ -= b->data()->size();
+        }
+        forward(slot, b);
+    }
+
+    /// Hub we are registered to.
+    HFlow *hub_;
+    /// Port to forward the messages to.
+    port_type *port_;
+    /// Queue limit in messages. 0 for unlimited.
+    unsigned maxFrames_;
+    /// Queue limit in bytes. 0 for unlimited.
+    size_t maxBytes_;
+    /// What to do when the limits are exceeded.
+    Policy policy_;
+    /// Notified when the policy triggered a disconnect.
+    Notifiable *onDisconnect_;
+    /// Messages waiting for a free slot.
+    QList<1> queue_;
+    /// Total payload bytes in queue_.
+    size_t queuedBytes_{0};
+    /// Counts messages dropped.
+    unsigned droppedFrames_{0};
+    /// Counts payload bytes dropped.
+    size_t droppedBytes_{0};
+    /// True if we unregistered from the hub.
+    bool disconnected_{false};
+    /// Buffers in flight to the port.
+    Slot slots_[MAX_IN_FLIGHT];
+};
+
+template <class HFlow> constexpr unsigned LimitedHubPort<HFlow>::MAX_IN_FLIGHT;
+
+#endif // _UTILS_LIMITEDHUBPORT_HXX_
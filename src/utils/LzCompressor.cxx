@@ -0,0 +1,274 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file LzCompressor.cxx
+ *
+ * Streaming LZ77-style compression for mostly-ASCII text such as cdi.xml.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include "utils/LzCompressor.hxx"
+
+const char LzDefs::DICTIONARY[] =
+    "<?xml version=\"1.0\"?>\n<cdi "
+    "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+    "xsi:noNamespaceSchemaLocation=\"http://openlcb.org/schema/cdi/1/1/"
+    "cdi.xsd\">\n<identification>\n<manufacturer></manufacturer>\n<model>"
+    "</model>\n<hardwareVersion></hardwareVersion>\n<softwareVersion>"
+    "</softwareVersion>\n</identification>\n<acdi/>\n<segment space='251' "
+    "origin='1'>\n<string size='63'>\n<name>User name</name>\n<description>"
+    "This name will appear in network browsers for the current node."
+    "</description>\n</string>\n<string size='64'>\n<name>User description"
+    "</name>\n<description>This description will appear in network browsers "
+    "for the current node.</description>\n</string>\n</segment>\n<segment "
+    "space='253' origin='128'>\n<group>\n<name>Internal data</name>\n"
+    "<description>Do not change these settings.</description>\n<int size='2'>"
+    "\n<name>Version</name>\n</int>\n<int size='2'>\n<name>Next event ID"
+    "</name>\n</int>\n</group>\n<group replication=''>\n<name>Description"
+    "</name>\n<description>User name of this </description>\n<repname>"
+    "</repname>\n<group offset=''/>\n<map>\n<relation>\n<property>"
+    "</property>\n<value></value>\n</relation>\n</map>\n<min></min>\n<max>"
+    "</max>\n<default></default>\n<int size='1'>\n<eventid>\n<name>Event "
+    "On</name>\n</eventid>\n<eventid>\n<name>Event Off</name>\n</eventid>\n"
+    "</int>\n</group>\n</segment>\n</cdi>\n";
+
+const unsigned LzDefs::DICTIONARY_SIZE = sizeof(DICTIONARY) - 1;
+
+LzCompressor::LzCompressor(const void *data, size_t len)
+    : data_(static_cast<const uint8_t *>(data))
+    , len_(len)
+{
+    reset();
+}
+
+void LzCompressor::reset()
+{
+    pos_ = 0;
+    offset_ = 0;
+    pending_[0] = FORMAT_VERSION;
+    pending_[1] = (len_ >> 24) & 0xff;
+    pending_[2] = (len_ >> 16) & 0xff;
+    pending_[3] = (len_ >> 8) & 0xff;
+    pending_[4] = len_ & 0xff;
+    pendingLen_ = HEADER_SIZE;
+    pendingPos_ = 0;
+}
+
+size_t LzCompressor::read(uint8_t *dst, size_t len)
+{
+    size_t count = 0;
+    while (count < len)
+    {
+        if (pendingPos_ >= pendingLen_)
+        {
+            if (pos_ >= len_)
+            {
+                break;
+            }
+            next_token();
+        }
+        dst[count++] = pending_[pendingPos_++];
+    }
+    offset_ += count;
+    return count;
+}
+
+void LzCompressor::next_token()
+{
+    pendingPos_ = 0;
+    // Looks for the longest match in the window.
+    size_t max_len = len_ - pos_;
+    if (max_len > MAX_MATCH)
+    {
+        max_len = MAX_MATCH;
+    }
+    size_t best_len = 0;
+    size_t best_dist = 0;
+    if (max_len >= MIN_MATCH)
+    {
+        size_t max_dist = pos_ + DICTIONARY_SIZE;
+        if (max_dist > MAX_DISTANCE)
+        {
+            max_dist = MAX_DISTANCE;
+        }
+        const uint8_t *cur = data_ + pos_;
+        for (size_t dist = 1; dist <= max_dist; ++dist)
+        {
+            ptrdiff_t cand = (ptrdiff_t)pos_ - (ptrdiff_t)dist;
+            if (at(cand) != cur[0] || at(cand + 1) != cur[1] ||
+                at(cand + best_len) != cur[best_len])
+            {
+                continue;
+            }
+            size_t l = 2;
+            while (l < max_len && at(cand + l) == cur[l])
+            {
+                ++l;
+            }
+            if (l > best_len)
+            {
+                best_len = l;
+                best_dist = dist;
+                if (l == max_len)
+                {
+                    break;
+                }
+            }
+        }
+    }
+    if (best_len >= MIN_MATCH)
+    {
+        unsigned l = best_len < EXT_MATCH ? best_len - MIN_MATCH : 15;
+        pending_[0] = 0x80 | (l << 3) | (best_dist >> 8);
+        pending_[1] = best_dist & 0xff;
+        pendingLen_ = 2;
+        if (l == 15)
+        {
+            pending_[pendingLen_++] = best_len - EXT_MATCH;
+        }
+        pos_ += best_len;
+        return;
+    }
+    uint8_t c = data_[pos_++];
+    if (c < 0x80)
+    {
+        pending_[0] = c;
+        pendingLen_ = 1;
+    }
+    else
+    {
+        pending_[0] = 0x80;
+        pending_[1] = 0;
+        pending_[2] = c;
+        pendingLen_ = 3;
+    }
+}
+
+std::string LzCompressor::compress(const void *data, size_t len)
+{
+    LzCompressor c(data, len);
+    std::string ret;
+    uint8_t buf[256];
+    size_t count;
+    while ((count = c.read(buf, sizeof(buf))) > 0)
+    {
+        ret.append((const char *)buf, count);
+    }
+    return ret;
+}
+
+void LzDecompressor::reset()
+{
+    headerLen_ = 0;
+    tokenLen_ = 0;
+    size_ = 0;
+    produced_ = 0;
+}
+
+bool LzDecompressor::consume(const void *data, size_t len, std::string *out)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < len; ++i)
+    {
+        uint8_t c = p[i];
+        if (headerLen_ < HEADER_SIZE)
+        {
+            if (headerLen_ == 0)
+            {
+                if (c != FORMAT_VERSION)
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                size_ = (size_ << 8) | c;
+            }
+            ++headerLen_;
+            continue;
+        }
+        if (produced_ >= size_)
+        {
+            return false;
+        }
+        token_[tokenLen_++] = c;
+        if (token_[0] < 0x80)
+        {
+            out->push_back(token_[0]);
+            ++produced_;
+            tokenLen_ = 0;
+            continue;
+        }
+        if (tokenLen_ < 2)
+        {
+            continue;
+        }
+        unsigned l = (token_[0] >> 3) & 15;
+        size_t dist = ((token_[0] & 7) << 8) | token_[1];
+        if (dist == 0)
+        {
+            if (l != 0)
+            {
+                return false;
+            }
+            if (tokenLen_ < 3)
+            {
+                continue;
+            }
+            out->push_back(token_[2]);
+            ++produced_;
+            tokenLen_ = 0;
+            continue;
+        }
+        size_t count = l + MIN_MATCH;
+        if (l == 15)
+        {
+            if (tokenLen_ < 3)
+            {
+                continue;
+            }
+            count = EXT_MATCH + token_[2];
+        }
+        tokenLen_ = 0;
+        if (dist > produced_ + DICTIONARY_SIZE || produced_ + count > size_)
+        {
+            return false;
+        }
+        // Offsets relative to the beginning of this stream's output; negative
+        // ones are in the preset dictionary.
+        size_t base = out->size() - produced_;
+        ptrdiff_t from = (ptrdiff_t)produced_ - (ptrdiff_t)dist;
+        for (size_t k = 0; k < count; ++k, ++from)
+        {
+            out->push_back(from >= 0 ? (*out)[base + from]
+                                     : DICTIONARY[DICTIONARY_SIZE + from]);
+        }
+        produced_ += count;
+    }
+    return true;
+}
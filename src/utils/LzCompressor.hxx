@@ -0,0 +1,201 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file LzCompressor.hxx
+ *
+ * Streaming LZ77-style compression for mostly-ASCII text such as cdi.xml.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _UTILS_LZCOMPRESSOR_HXX_
+#define _UTILS_LZCOMPRESSOR_HXX_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+/// Constants describing the compressed format.
+///
+/// The compressed stream starts with a header: one byte of format version
+/// (currently 1), then the uncompressed length as a 32-bit big-endian
+/// number. Then come the tokens:
+///
+/// - 0x00..0x7F: a literal byte.
+///
+/// - 1LLLLDDD DDDDDDDD: copy L + 3 bytes starting D bytes back in the
+/// output. D is between 1 and 2047. When L == 15, an extra byte follows which
+/// is added to the length.
+///
+/// - 0x80 0x00 X: literal byte X (used for bytes 0x80..0xFF).
+///
+/// Back-references may reach before the beginning of the output into a fixed
+/// preset dictionary of common cdi.xml fragments (DICTIONARY), which is
+/// logically prepended to the output. This is what makes short documents
+/// compress well.
+struct LzDefs
+{
+    /// Preset dictionary. Both ends of the stream need the identical contents
+    /// (see also bin/cdi_decompress.py), so changing it needs a new
+    /// FORMAT_VERSION.
+    static const char DICTIONARY[];
+    /// Number of bytes in DICTIONARY (without the terminating zero).
+    static const unsigned DICTIONARY_SIZE;
+
+    enum
+    {
+        /// Version byte at the beginning of the compressed stream.
+        FORMAT_VERSION = 1,
+        /// Number of bytes in the stream header.
+        HEADER_SIZE = 5,
+        /// Largest distance of a back-reference.
+        MAX_DISTANCE = 2047,
+        /// Shortest back-reference.
+        MIN_MATCH = 3,
+        /// Match length beyond which an extra length byte is needed.
+        EXT_MATCH = MIN_MATCH + 15,
+        /// Longest back-reference.
+        MAX_MATCH = EXT_MATCH + 255,
+        /// Longest token in bytes.
+        MAX_TOKEN = 3,
+    };
+};
+
+/// Compresses a block of memory in a streaming fashion. The compressed data is
+/// produced on demand, in arbitrarily sized pieces. The state is a few bytes,
+/// and the input is only read (it can be in flash). Seeking backwards in the
+/// output needs a reset() and recompressing from the beginning.
+class LzCompressor : public LzDefs
+{
+public:
+    /// @param data is the input to compress. Must stay alive as long as this
+    /// object is used.
+    /// @param len is the number of bytes in data.
+    LzCompressor(const void *data, size_t len);
+
+    /// Restarts the compressed stream from the beginning.
+    void reset();
+
+    /// Produces the next piece of compressed output.
+    ///
+    /// @param dst is where to write the compressed bytes.
+    /// @param len is the maximum number of bytes to write.
+    /// @return number of bytes written. Less than len only at the end of the
+    /// compressed stream.
+    size_t read(uint8_t *dst, size_t len);
+
+    /// @return how many compressed bytes were returned by read() since the
+    /// last reset.
+    size_t offset()
+    {
+        return offset_;
+    }
+
+    /// Compresses a whole block of memory at once.
+    /// @param data is the input to compress.
+    /// @param len is the number of bytes in data.
+    /// @return the compressed stream.
+    static std::string compress(const void *data, size_t len);
+
+private:
+    /// Encodes the next token into pending_.
+    void next_token();
+
+    /// @param ofs is an offset relative to the beginning of the input. Negative
+    /// values refer to the preset dictionary.
+    /// @return the byte at that offset.
+    uint8_t at(ptrdiff_t ofs)
+    {
+        return ofs >= 0 ? data_[ofs] : DICTIONARY[DICTIONARY_SIZE + ofs];
+    }
+
+    /// Input data.
+    const uint8_t *data_;
+    /// Number of bytes in the input.
+    size_t len_;
+    /// Next input byte to encode.
+    size_t pos_;
+    /// Compressed bytes produced so far.
+    size_t offset_;
+    /// Encoded bytes not yet returned by read().
+    uint8_t pending_[HEADER_SIZE];
+    /// Number of valid bytes in pending_.
+    uint8_t pendingLen_;
+    /// Number of bytes in pending_ already returned.
+    uint8_t pendingPos_;
+};
+
+/// Decompresses a stream produced by LzCompressor. The input can be fed in
+/// arbitrarily sized pieces (for example as it arrives in memory config read
+/// replies).
+class LzDecompressor : public LzDefs
+{
+public:
+    LzDecompressor()
+    {
+        reset();
+    }
+
+    /// Restarts with an empty stream.
+    void reset();
+
+    /// Decompresses a piece of the stream.
+    ///
+    /// @param data is the next compressed bytes.
+    /// @param len is the number of bytes in data.
+    /// @param out is the decompressed output. Must hold all output from the
+    /// previous calls since reset(); back-references are resolved against it.
+    /// @return false if the stream is malformed.
+    bool consume(const void *data, size_t len, std::string *out);
+
+    /// @return true when the entire uncompressed data is in the output.
+    bool done()
+    {
+        return headerLen_ == HEADER_SIZE && produced_ == size_;
+    }
+
+    /// @return the uncompressed length announced by the stream header, or
+    /// zero if the header has not arrived yet.
+    uint32_t size()
+    {
+        return size_;
+    }
+
+private:
+    /// Bytes of the header seen so far.
+    uint8_t headerLen_;
+    /// Bytes of the current (incomplete) token.
+    uint8_t tokenLen_;
+    /// Current incomplete token.
+    uint8_t token_[MAX_TOKEN];
+    /// Uncompressed length from the header.
+    uint32_t size_;
+    /// Number of bytes output so far.
+    uint32_t produced_;
+};
+
+#endif // _UTILS_LZCOMPRESSOR_HXX_
@@ -38,16 +38,9 @@
 
 #include <stdint.h>
 #include <utility>
+#include <vector>
 
-#include "utils/StlMap.hxx"
-#include "utils/LinearMap.hxx"
-#include "utils/SysMap.hxx"
-
-
-#if UINTPTR_MAX > UINT32_MAX
-#define NODEHANDLER_USE_PAIR
-#endif
-
+#include "utils/macros.h"
 
 /** A map that allows registration and lookup or per-node handler of a
  *  particular message ID.
@@ -57,40 +50,64 @@
  *  The map supports registering handlers for a message ID globally by
  *  supplying nullptr as the node. These will be returned for nodes that have
  *  no specific handler for that particular message ID.
+ *
+ *  The implementation is a flat open-addressing hash table with linear
+ *  probing, keyed by the full (node pointer, ID) pair, so it works the same
+ *  on 32- and 64-bit hosts. Lookups are on the receive path of every datagram
+ *  and memory config request, which is why this is not a std::map.
  */
 class NodeHandlerMapBase
 {
 private:
-#ifdef NODEHANDLER_USE_PAIR
-    /// Standard payload type.
-    typedef std::pair<void*, uint32_t> key_type;
-#else
-    /// Compacted payload type.
-    typedef uint64_t key_type;
-#endif
-    /// Generic handler type that we'll keep.
-    typedef void* value_type;
-    /// Type of the storage object.
-    typedef StlMap<key_type, value_type> map_type;
+    /// One slot of the hash table.
+    struct Entry
+    {
+        /// Node for which the handler is registered, nullptr for all nodes.
+        void *node;
+        /// Message ID for which the handler is registered.
+        uint32_t id;
+        /// The registered handler. nullptr if the slot is empty.
+        void *value;
+    };
 
 public:
     NodeHandlerMapBase()
     {
     }
 
-    /// Creates a map with @param entries capacity.
-    NodeHandlerMapBase(size_t entries) : entries_(entries)
+    /// Creates a map with @param entries capacity. The map will grow if more
+    /// entries are inserted.
+    NodeHandlerMapBase(size_t entries)
     {
+        size_t sz = MIN_SIZE;
+        while (sz < entries * 2)
+        {
+            sz <<= 1;
+        }
+        entries_.resize(sz);
     }
 
-    /** Inserts a handler into the map.
+    /** Inserts a handler into the map. Replaces any handler that was
+     * registered before for the same node and ID.
      * @param node is the node for which to register the handler.
      * @param id is the message ID for which to register.
      * @param value is the handler to register.
      */
     void insert(void* node, uint32_t id, void* value)
     {
-        entries_[make_key(node, id)] = value;
+        HASSERT(value);
+        if ((size_ + 1) * 2 > entries_.size())
+        {
+            grow();
+        }
+        Entry *e = find_slot(node, id);
+        if (!e->value)
+        {
+            ++size_;
+            e->node = node;
+            e->id = id;
+        }
+        e->value = value;
     }
 
     /// Removes a handlerfrom this map.
@@ -101,11 +118,17 @@ public:
     /// @param value is the pointer to the handler.
     void erase(void *node, uint32_t id, void *value)
     {
-        auto it = entries_.find(make_key(node, id));
-        if (it == entries_.end()) return;
-        if (it->second == value) {
-            entries_.erase(it);
+        if (entries_.empty())
+        {
+            return;
+        }
+        Entry *e = find_slot(node, id);
+        if (!e->value || e->value != value)
+        {
+            return;
         }
+        remove_slot(e - &entries_[0]);
+        --size_;
     }
     
     /** Finds a handler for a particular node and particular messageID.
@@ -115,64 +138,174 @@ public:
      * @param id is the message ID to look up */
     void* lookup(void* node, uint32_t id)
     {
-        auto it = entries_.find(make_key(node, id));
-        if (it == entries_.end())
-        {
-            it = entries_.find(make_key(nullptr, id));
-        }
-        if (it == entries_.end())
+        if (!size_)
         {
             return nullptr;
         }
-        else
+        void *value = find_slot(node, id)->value;
+        if (!value && node)
         {
-            return it->second;
+            value = find_slot(nullptr, id)->value;
         }
+        return value;
     }
 
-    /// Iterator type.
-    typedef typename map_type::Iterator iterator;
+    /// @return the number of registered handlers.
+    size_t size()
+    {
+        return size_;
+    }
+
+    /// Iterator over the registered handlers.
+    class iterator
+    {
+    public:
+        /// advance
+        void operator++()
+        {
+            ++e_;
+            skip_empty();
+        }
+
+        /// @return comparison
+        bool operator!=(const iterator &o)
+        {
+            return e_ != o.e_;
+        }
+
+        /// @return the node of the current entry.
+        void *node()
+        {
+            return e_->node;
+        }
+
+        /// @return the message ID of the current entry.
+        uint32_t id()
+        {
+            return e_->id;
+        }
+
+        /// @return the handler of the current entry.
+        void *value()
+        {
+            return e_->value;
+        }
+
+    private:
+        friend class NodeHandlerMapBase;
+
+        /// @param e current slot @param end past the last slot
+        iterator(Entry *e, Entry *end)
+            : e_(e)
+            , end_(end)
+        {
+            skip_empty();
+        }
+
+        /// Advances to the next used slot.
+        void skip_empty()
+        {
+            while (e_ != end_ && !e_->value)
+            {
+                ++e_;
+            }
+        }
+
+        /// Current slot.
+        Entry *e_;
+        /// Past the last slot.
+        Entry *end_;
+    };
+
     /// @return begin iterator
     iterator begin()
     {
-        return entries_.begin();
+        return iterator(entries_.data(), entries_.data() + entries_.size());
     }
 
     /// @return end iterator
     iterator end()
     {
-        return entries_.end();
+        Entry *e = entries_.data() + entries_.size();
+        return iterator(e, e);
+    }
+
+private:
+    /// Initial number of slots.
+    static constexpr size_t MIN_SIZE = 8;
+
+    /// @return the hash of a key. @param node @param id are the key.
+    static uint32_t hash(void *node, uint32_t id)
+    {
+        uint64_t n = reinterpret_cast<uintptr_t>(node);
+        uint32_t h = (uint32_t)n ^ (uint32_t)(n >> 32);
+        h = h * 0x9E3779B1u ^ id;
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        return h;
     }
 
-    /// Decodes a compact key into a pair. @param key is what to
-    /// decode. @return decoded key (classic iterator pair value).
-    static pair<void *, uint32_t> read_key(key_type key)
+    /// @return the home slot of a key. @param node @param id are the key.
+    size_t home(void *node, uint32_t id)
     {
-#ifdef NODEHANDLER_USE_PAIR
-        return key;
-#else
-        uint32_t id = key & 0xFFFFFFFFU;
-        uint32_t n = key >> 32;
-        return std::make_pair(reinterpret_cast<void *>(n), id);
-#endif
+        return hash(node, id) & (entries_.size() - 1);
     }
 
-private:
-    /// Combines the node pointer and the message ID into a lookup key.
-    key_type make_key(void* node, uint32_t id)
+    /// Finds the slot holding a given key, or the empty slot where the key
+    /// should be inserted. @param node @param id are the key. @return slot.
+    Entry *find_slot(void *node, uint32_t id)
     {
-#ifdef NODEHANDLER_USE_PAIR
-        return std::make_pair(node, id);
-#else
-        uint64_t key = reinterpret_cast<uint32_t>(node);
-        key <<= 32;
-        key |= id;
-        return key;
-#endif
+        size_t mask = entries_.size() - 1;
+        for (size_t i = home(node, id);; i = (i + 1) & mask)
+        {
+            Entry *e = &entries_[i];
+            if (!e->value || (e->node == node && e->id == id))
+            {
+                return e;
+            }
+        }
+    }
+
+    /// Clears a slot, moving later entries of the probe sequence back so
+    /// that no tombstones are needed. @param i index of the slot to clear.
+    void remove_slot(size_t i)
+    {
+        size_t mask = entries_.size() - 1;
+        for (size_t j = (i + 1) & mask; entries_[j].value; j = (j + 1) & mask)
+        {
+            size_t k = home(entries_[j].node, entries_[j].id);
+            // Entry j can move to the hole at i if its home slot is not
+            // cyclically in (i, j].
+            bool stays = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+            if (!stays)
+            {
+                entries_[i] = entries_[j];
+                i = j;
+            }
+        }
+        entries_[i].value = nullptr;
+    }
+
+    /// Doubles the number of slots.
+    void grow()
+    {
+        std::vector<Entry> old(
+            entries_.empty() ? MIN_SIZE : entries_.size() * 2);
+        old.swap(entries_);
+        for (const Entry &e : old)
+        {
+            if (e.value)
+            {
+                *find_slot(e.node, e.id) = e;
+            }
+        }
     }
 
-    /// The actual storage object.
-    map_type entries_;
+    /// Hash table. The size is zero or a power of two.
+    std::vector<Entry> entries_;
+    /// Number of used slots.
+    size_t size_{0};
 };
 
 /** A type-safe map that allows registration and lookup or per-node handler of
@@ -242,9 +375,9 @@ public:
 
         /// Dereference. @return pair
         std::pair<std::pair<Node*, uint32_t>, Handler*> operator*() {
-            auto p = NodeHandlerMapBase::read_key(impl_->first);
-            return std::make_pair(std::make_pair((Node*) p.first, p.second),
-                                  (Handler*)impl_->second);
+            return std::make_pair(
+                std::make_pair((Node *)impl_.node(), impl_.id()),
+                (Handler *)impl_.value());
         }
 
     private:
@@ -74,6 +74,8 @@ protected:
     /** ActiveTimers needs to iterate through the queue. */
     friend class ExecutorBase;
     friend class TimerTest;
+    /** The lock-free queue links the members itself. */
+    template <unsigned ITEMS> friend class QListLockFree;
 };
 
 #endif /* _UTILS_QMEMBER_HXX_ */
@@ -46,6 +46,14 @@
 #include "utils/QMember.hxx"
 #include "utils/macros.h"
 
+/// Nonzero if pointers can be exchanged atomically without a lock on this
+/// platform, which QListLockFree needs.
+#if __GCC_ATOMIC_POINTER_LOCK_FREE == 2
+#define LOCK_FREE_QUEUE_AVAILABLE 1
+#else
+#define LOCK_FREE_QUEUE_AVAILABLE 0
+#endif
+
 namespace openlcb
 {
 class AsyncIfTest;
@@ -700,6 +708,179 @@ public:
     }
 };
 
+/** A list of queues that any number of threads (or interrupts) can insert
+ * into without taking a lock, while a single consumer thread takes items out
+ * with next(). Index 0 is the highest priority.
+ *
+ * Each priority band is an intrusive stack that the producers push onto with
+ * a compare-and-swap. When the consumer's private list of a band runs dry, it
+ * takes the entire stack with one atomic exchange and reverses it, which
+ * keeps the items of a band in the order they were inserted. There is no
+ * window in which an inserted item is invisible to the consumer, therefore
+ * the consumer never needs to spin or wait on a producer.
+ *
+ * Requires lock-free pointer atomics, see LOCK_FREE_QUEUE_AVAILABLE.
+ */
+template <unsigned ITEMS> class QListLockFree : public QInterface
+{
+public:
+    /** Default Constructor.
+     */
+    QListLockFree()
+    {
+    }
+
+    /** Destructor.
+     */
+    ~QListLockFree()
+    {
+    }
+
+    /** Add an item to the back of the queue. Can be called from any thread.
+     * @param item to add to queue
+     * @param index in the list to operate on
+     */
+    void insert(QMember *item, unsigned index) override
+    {
+        if (index >= ITEMS)
+        {
+            index = ITEMS - 1;
+        }
+        Band *b = &bands_[index];
+        // Counted before the push, so that pending() never goes below zero.
+        __atomic_fetch_add(&b->count_, 1, __ATOMIC_RELAXED);
+        QMember *head = __atomic_load_n(&b->incoming_, __ATOMIC_RELAXED);
+        do
+        {
+            item->next = head;
+        } while (!__atomic_compare_exchange_n(&b->incoming_, &head, item,
+            true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+
+    /** Get an item from the front of the queue. Must only be called from the
+     * consumer thread.
+     * @param index in the list to operate on
+     * @return item retrieved from queue, NULL if no item available
+     */
+    QMember *next(unsigned index) override
+    {
+        Band *b = &bands_[index];
+        if (!b->outgoing_)
+        {
+            if (!__atomic_load_n(&b->incoming_, __ATOMIC_RELAXED))
+            {
+                return nullptr;
+            }
+            QMember *stack =
+                __atomic_exchange_n(&b->incoming_, nullptr, __ATOMIC_ACQUIRE);
+            // Reverses the stack into insertion order.
+            QMember *list = nullptr;
+            while (stack)
+            {
+                QMember *n = stack->next;
+                stack->next = list;
+                list = stack;
+                stack = n;
+            }
+            b->outgoing_ = list;
+        }
+        QMember *result = b->outgoing_;
+        b->outgoing_ = result->next;
+        result->next = nullptr;
+        __atomic_fetch_sub(&b->count_, 1, __ATOMIC_RELAXED);
+        return result;
+    }
+
+    /** Get an item from the front of the queue queue in priority order. Must
+     * only be called from the consumer thread.
+     * @return item retrieved from queue + index, NULL if no item available
+     */
+    Result next() override
+    {
+        for (unsigned i = 0; i < ITEMS; ++i)
+        {
+            QMember *result = next(i);
+            if (result)
+            {
+                return Result(result, i);
+            }
+        }
+        return Result();
+    }
+
+    /** Get the number of pending items in the queue. Items that are being
+     * inserted concurrently may already be counted.
+     * @param index in the list to operate on
+     * @return number of pending items in the queue
+     */
+    size_t pending(unsigned index) override
+    {
+        return __atomic_load_n(&bands_[index].count_, __ATOMIC_RELAXED);
+    }
+
+    /** Get the total number of pending items in all queues in the list.
+     * @return number of total pending items in all queues in the list
+     */
+    size_t pending() override
+    {
+        size_t result = 0;
+        for (unsigned i = 0; i < ITEMS; ++i)
+        {
+            result += pending(i);
+        }
+        return result;
+    }
+
+    /// @return how many entries are enqueued right now (across all lists).
+    size_t size()
+    {
+        return pending();
+    }
+
+    /** Test if the queue is empty.
+     * @param index in the list to operate on
+     * @return true if empty, else false
+     */
+    bool empty(unsigned index) override
+    {
+        return pending(index) == 0;
+    }
+
+    /** Test if all the queues are empty.
+     * @return true if empty (all lists), else false
+     */
+    bool empty() override
+    {
+        for (unsigned i = 0; i < ITEMS; ++i)
+        {
+            if (pending(i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    /// One priority band.
+    struct Band
+    {
+        /// Stack of the inserted items, newest first. Shared with the
+        /// producers.
+        QMember *incoming_ = nullptr;
+        /// Number of items in the band, including the ones being inserted.
+        size_t count_ = 0;
+        /// Items taken from incoming_ in insertion order. Owned by the
+        /// consumer.
+        QMember *outgoing_ = nullptr;
+    };
+
+    /// The priority bands.
+    Band bands_[ITEMS];
+
+    DISALLOW_COPY_AND_ASSIGN(QListLockFree);
+};
+
 #if 0
 /** A BufferQueue that adds the ability to wait on the next buffer.
  * Yes this uses multiple inheritance.
@@ -1004,4 +1185,115 @@ private:
     DISALLOW_COPY_AND_ASSIGN(QListProtectedWait);
 };
 
+/** A lock-free list of queues (see QListLockFree) that adds the ability to
+ * wait on the next item. The semaphore is counted the same way as in
+ * QListProtectedWait, so the two are interchangeable.
+ */
+template <unsigned items>
+class QListLockFreeWait : public QListLockFree<items>, public OSSem
+{
+public:
+    /** Default Constructor.
+     */
+    QListLockFreeWait()
+        : QListLockFree<items>()
+        , OSSem(0)
+    {
+    }
+
+    /** Default destructor.
+     */
+    ~QListLockFreeWait()
+    {
+    }
+
+    /** Add an item to the back of the queue.
+     * @param item item to add to queue
+     * @param index in the list to operate on
+     */
+    void insert(QMember *item, unsigned index) override
+    {
+        QListLockFree<items>::insert(item, index);
+        post();
+    }
+
+#ifdef __FreeRTOS__
+    /** Add an item to the back of the queue.
+     * @param item item to add to queue
+     * @param index in the list to operate on
+     */
+    void insert_from_isr(QMember *item, unsigned index)
+    {
+        int woken = 0;
+        QListLockFree<items>::insert(item, index);
+        this->post_from_isr(&woken);
+    }
+#endif
+
+    /** Translate the Result type */
+    typedef typename QListLockFree<items>::Result Result;
+
+    /** Get an item from the front of the queue.
+     * @return item retrieved from one of the queues
+     */
+    Result next() override
+    {
+        Result result = QListLockFree<items>::next();
+        if (result.item != NULL)
+        {
+            /* decrement semaphore */
+            OSSem::wait();
+        }
+        return result;
+    }
+
+    /** Wait for an item from the front of the queue.
+     * @return item retrieved from queue, else NULL with errno set:
+     *         EINTR - woken up asynchronously
+     */
+    Result wait()
+    {
+        OSSem::wait();
+        Result result = QListLockFree<items>::next();
+        if (result.item == NULL)
+        {
+            errno = EINTR;
+        }
+        return result;
+    }
+
+#ifndef ESP_NONOS
+    /** Wait for an item from the front of the queue.
+     * @param timeout time to wait in nanoseconds
+     * @return item retrieved from queue, else NULL with errno set:
+     *         ETIMEDOUT - timeout occured, EINTR - woken up asynchronously
+     */
+    Result timedwait(long long timeout)
+    {
+        if (OSSem::timedwait(timeout) != 0)
+        {
+            errno = ETIMEDOUT;
+            return {NULL, 0};
+        }
+
+        Result result = QListLockFree<items>::next();
+        if (result.item == NULL)
+        {
+            errno = EINTR;
+        }
+        return result;
+    }
+#endif
+
+    /** Wakeup anyone waiting on the wait queue.
+     */
+    void wakeup()
+    {
+        post();
+    }
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(QListLockFreeWait);
+};
+
 #endif /* _UTILS_QUEUE_HXX_ */
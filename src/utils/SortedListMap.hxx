@@ -71,7 +71,28 @@ public:
     /// @return last iterator.
     iterator end()
     {
-        return container_.begin() + sortedCount_;
+        lazy_init();
+        return container_.end();
+    }
+
+    /// @return number of elements in the set.
+    size_t size()
+    {
+        return container_.size();
+    }
+
+    /// Removes all entries and releases the memory.
+    void clear()
+    {
+        container_type().swap(container_);
+        sortedCount_ = 0;
+    }
+
+    /// Preallocates space for a number of entries.
+    /// @param n how many entries the set should hold without reallocation.
+    void reserve(size_t n)
+    {
+        container_.reserve(n);
     }
 
     /// @param key what to search for @return iterator, see std::lower_bound.
@@ -110,16 +131,39 @@ public:
     /// Removes an entry from the vector, pointed by an iterator.
     void erase(const iterator &it)
     {
+        if (it < container_.begin() + sortedCount_)
+        {
+            --sortedCount_;
+        }
         container_.erase(it);
     }
 
+    /// Removes all entries for which a predicate returns true. Runs in linear
+    /// time and keeps the remaining entries in sorted order.
+    /// @param pred is called with a const data_type&; returns true if the
+    /// entry should be removed.
+    template <class P> void remove_if(P pred)
+    {
+        lazy_init();
+        container_.erase(
+            std::remove_if(container_.begin(), container_.end(), pred),
+            container_.end());
+        sortedCount_ = container_.size();
+    }
+
 private:
-    /// Reestablishes sorted order in case anything was inserted or removed.
+    /// Reestablishes sorted order in case anything was inserted. Only the
+    /// entries appended since the last call get sorted; these are then merged
+    /// into the already sorted prefix, so interleaving a few insertions with
+    /// lookups does not re-sort the entire container every time.
     void lazy_init()
     {
         if (sortedCount_ != container_.size())
         {
-            sort(container_.begin(), container_.end(), CMP());
+            auto middle = container_.begin() + sortedCount_;
+            std::sort(middle, container_.end(), CMP());
+            std::inplace_merge(
+                container_.begin(), middle, container_.end(), CMP());
             sortedCount_ = container_.size();
         }
     }
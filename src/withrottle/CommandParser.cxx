@@ -0,0 +1,245 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file withrottle/CommandParser.cxx
+ *
+ * Incremental parser turning a WiThrottle byte stream into commands.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include "withrottle/CommandParser.hxx"
+
+namespace withrottle
+{
+
+/** Separates the train description from the sub-command in a multi-throttle
+ * command. */
+static const char TRAIN_DELIMITER[] = "<;>";
+
+/*
+ * CommandParser::parse()
+ */
+bool CommandParser::parse(const char **data, size_t *len,
+                          ThrottleCommand *command)
+{
+    const char *p = *data;
+    const char *end = p + *len;
+    bool done = false;
+
+    while (p < end && !done)
+    {
+        done = consume(*p++, command);
+    }
+
+    *len -= p - *data;
+    *data = p;
+    return done;
+}
+
+/*
+ * CommandParser::consume()
+ */
+bool CommandParser::consume(char c, ThrottleCommand *command)
+{
+    if (c == '\n' || c == '\r')
+    {
+        ServerState last = state_;
+        state_ = STATE_COMMAND;
+        if (last == STATE_PAYLOAD)
+        {
+            command->payload[length_] = '\0';
+            return true;
+        }
+        /* empty or incomplete line */
+        return false;
+    }
+
+    switch (state_)
+    {
+        case STATE_COMMAND:
+            start_command(c, command);
+            break;
+        case STATE_MULTI_ID:
+            state_ = c == 'T' ? STATE_MULTI_TYPE : STATE_NEXT;
+            break;
+        case STATE_MULTI_TYPE:
+            switch (c)
+            {
+                case ACTION:
+                case ADD:
+                case REMOVE:
+                    command->commandMultiType = (CommandMultiType)c;
+                    length_ = 0;
+                    delimMatch_ = 0;
+                    state_ = STATE_TRAIN;
+                    break;
+                default:
+                    state_ = STATE_NEXT;
+                    break;
+            }
+            break;
+        case STATE_TRAIN:
+            append_train(c, command);
+            break;
+        case STATE_SUBCOMMAND:
+            if (is_subcommand(c))
+            {
+                command->commandSubType = (CommandSubType)c;
+                length_ = 0;
+                state_ = STATE_PAYLOAD;
+            }
+            else
+            {
+                state_ = STATE_NEXT;
+            }
+            break;
+        case STATE_PAYLOAD:
+            if (length_ < ThrottleCommand::MAX_PAYLOAD_SIZE)
+            {
+                command->payload[length_++] = c;
+            }
+            else
+            {
+                /* payload too long */
+                state_ = STATE_NEXT;
+            }
+            break;
+        default:
+        case STATE_NEXT:
+            break;
+    }
+
+    return false;
+}
+
+/*
+ * CommandParser::start_command()
+ */
+void CommandParser::start_command(char c, ThrottleCommand *command)
+{
+    command->commandType = (CommandType)c;
+    command->train[0] = '\0';
+    command->payload[0] = '\0';
+    length_ = 0;
+
+    switch (c)
+    {
+        case PRIMARY:
+        case SECONDARY:
+            state_ = STATE_SUBCOMMAND;
+            break;
+        case MULTI:
+            state_ = STATE_MULTI_ID;
+            break;
+        case HEARTBEAT:
+        case SET_NAME:
+        case SET_ID:
+            state_ = STATE_PAYLOAD;
+            break;
+        default:
+        case HEX_PACKET:
+        case PANEL:
+        case ROSTER:
+        case QUIT:
+            state_ = STATE_NEXT;
+            break;
+    }
+}
+
+/*
+ * CommandParser::append_train()
+ */
+void CommandParser::append_train(char c, ThrottleCommand *command)
+{
+    if (c == TRAIN_DELIMITER[delimMatch_])
+    {
+        if (++delimMatch_ == sizeof(TRAIN_DELIMITER) - 1)
+        {
+            command->train[length_] = '\0';
+            /* an empty train description is invalid */
+            state_ = length_ ? STATE_SUBCOMMAND : STATE_NEXT;
+        }
+        return;
+    }
+
+    /* The bytes that looked like the start of a delimiter were not one.
+     * Since the delimiter does not overlap itself, only a '<' can start a
+     * new match. */
+    unsigned matched = delimMatch_;
+    delimMatch_ = 0;
+    if (c == TRAIN_DELIMITER[0])
+    {
+        delimMatch_ = 1;
+    }
+    if (length_ + matched + (delimMatch_ ? 0 : 1) >
+        ThrottleCommand::MAX_TRAIN_SIZE)
+    {
+        /* train description too long */
+        state_ = STATE_NEXT;
+        return;
+    }
+    for (unsigned i = 0; i < matched; ++i)
+    {
+        command->train[length_++] = TRAIN_DELIMITER[i];
+    }
+    if (!delimMatch_)
+    {
+        command->train[length_++] = c;
+    }
+}
+
+/*
+ * CommandParser::is_subcommand()
+ */
+bool CommandParser::is_subcommand(char c)
+{
+    switch (c)
+    {
+        case VELOCITY:
+        case ESTOP:
+        case FUNCTION:
+        case FORCE:
+        case DIRECTION:
+        case RELEASE:
+        case DISPATCH:
+        case ADDR_LONG:
+        case ADDR_SHORT:
+        case ADDR_ROSTER:
+        case CONSIST:
+        case CONSIST_LEAD:
+        case IDLE:
+        case SS_MODE:
+        case MOMENTARY:
+        case QUERY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} /* namespace withrottle */
@@ -0,0 +1,123 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file withrottle/CommandParser.hxx
+ *
+ * Incremental parser turning a WiThrottle byte stream into commands.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _WITHROTTLE_COMMANDPARSER_HXX_
+#define _WITHROTTLE_COMMANDPARSER_HXX_
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "withrottle/Defs.hxx"
+
+namespace withrottle
+{
+
+/** Streaming parser for the commands a WiThrottle client sends to the
+ * server. The input is consumed one byte at a time in a single pass; fields
+ * are copied straight into the command being assembled, so the parser keeps
+ * no copy of the stream and never allocates. Input may be split at arbitrary
+ * points between calls.
+ *
+ * Usage:
+ * @code
+ * while (parser.parse(&data, &len, command->data()))
+ * {
+ *     dispatcher.send(command);
+ *     command = dispatcher.alloc();
+ * }
+ * @endcode
+ */
+class CommandParser
+{
+public:
+    /** Constructor. */
+    CommandParser()
+        : state_(STATE_COMMAND)
+        , length_(0)
+        , delimMatch_(0)
+    {
+    }
+
+    /** Consumes input until a command is complete or the input runs out.
+     * @param data pointer to the input; advanced past the consumed bytes
+     * @param len number of bytes at *data; decremented by the consumed bytes
+     * @param command command being assembled. Must be the same object on
+     *        every call until this function returns true.
+     * @return true if command holds a complete command, false if all input
+     *         was consumed without completing one
+     */
+    bool parse(const char **data, size_t *len, ThrottleCommand *command);
+
+    /** Drops any partially parsed line. */
+    void reset()
+    {
+        state_ = STATE_COMMAND;
+    }
+
+private:
+    /** Processes one byte of input.
+     * @param c input byte
+     * @param command command being assembled
+     * @return true if the byte completed a command
+     */
+    bool consume(char c, ThrottleCommand *command);
+
+    /** Starts a new line with the command type byte.
+     * @param c command type byte
+     * @param command command being assembled
+     */
+    void start_command(char c, ThrottleCommand *command);
+
+    /** Appends a byte to the train description.
+     * @param c input byte
+     * @param command command being assembled
+     */
+    void append_train(char c, ThrottleCommand *command);
+
+    /** @return true if c is a sub-command we understand
+     * @param c input byte
+     */
+    static bool is_subcommand(char c);
+
+    /** Current state of parsing the data */
+    ServerState state_;
+    /** Number of bytes stored in the field currently being filled. */
+    uint8_t length_;
+    /** Number of bytes of the "<;>" train delimiter matched so far. */
+    uint8_t delimMatch_;
+};
+
+} /* namespace withrottle */
+
+#endif /* _WITHROTTLE_COMMANDPARSER_HXX_ */
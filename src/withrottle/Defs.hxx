@@ -30,6 +30,8 @@
 
 #include <string>
 
+#include "utils/macros.h"
+
 namespace withrottle
 {
 
@@ -106,11 +108,17 @@ public:
     /** type of the dispatcher criteria */
     typedef CommandType id_type;
 
+    /** maximum length of the train description, excluding the terminator */
+    static constexpr unsigned MAX_TRAIN_SIZE = 31;
+
+    /** maximum length of the command payload, excluding the terminator */
+    static constexpr unsigned MAX_PAYLOAD_SIZE = 63;
+
     CommandType commandType; /**< type of command */
     CommandMultiType commandMultiType; /**< type of multi throttle command */
     CommandSubType commandSubType; /**< type of throttle command */
-    string train; /**< The train description */
-    string payload; /**< the command payload */
+    char train[MAX_TRAIN_SIZE + 1]; /**< The train description, nul terminated */
+    char payload[MAX_PAYLOAD_SIZE + 1]; /**< the command payload, nul terminated */
 
     /** @returns the unique identifier of the reply message */
     id_type id()
@@ -124,6 +132,7 @@ public:
 enum ServerState
 {
     STATE_COMMAND = 0, /**< look for command */
+    STATE_MULTI_ID, /**< look for the multi-throttle identifier */
     STATE_MULTI_TYPE, /**< look for the multi-throttle type */
     STATE_TRAIN, /**< look for the train */
     STATE_SUBCOMMAND, /**< look for sub-command */
@@ -27,260 +27,329 @@
 
 #include "withrottle/Server.hxx"
 
+#include <fcntl.h>
+
 namespace withrottle
 {
 
+/*
+ * Server::~Server()
+ */
+Server::~Server()
+{
+    listener.shutdown();
+    /* let the pending updates go out, they are at most one period away */
+    SyncNotifiable n;
+    BarrierNotifiable bn(&n);
+    executor.sync_run([this, &bn]()
+    {
+        for (auto &t : trains)
+        {
+            t.second->flush(bn.new_child());
+        }
+    });
+    bn.maybe_done();
+    n.wait_for_notification();
+    executor.sync_run([this]()
+    {
+        for (auto &t : trains)
+        {
+            delete t.second;
+        }
+        trains.clear();
+    });
+}
+
+/*
+ * Server::add_connection()
+ */
+void Server::add_connection(int fd)
+{
+    ThrottleFlow *flow = new ThrottleFlow(this, fd);
+    flow->start();
+}
+
+/*
+ * Server::train()
+ */
+ServerTrain *Server::train(LocoAddress address)
+{
+    uint16_t key = address.address | (address.addressType << 14);
+    auto it = trains.find(key);
+    if (it != trains.end())
+    {
+        return it->second;
+    }
+    ServerTrain *t = new ServerTrain(this, address);
+    trains[key] = t;
+    return t;
+}
+
 /** Constructor.
- * @param service service this flow belongs to
+ * @param server server this flow belongs to
  * @param fd socket descriptor of throttle connection.
- * @param node OpenLCB node that proxies our throttles
  */
-ThrottleFlow::ThrottleFlow(Server *server, int fd, openlcb::Node *node)
+ThrottleFlow::ThrottleFlow(Server *server, int fd)
     : StateFlowBase(server)
-    , olcbThrottle(node)
     , server(server)
     , fd(fd)
-    , data()
-    , dataIndex(0)
-    , state(STATE_COMMAND)
+    , droppedWrites(0)
+    , writer(this)
+    , pendingCommands(this)
     , selectHelper(this)
     , dispatcher(server)
     , command(dispatcher.alloc())
     , serverCommandLoco(this)
 {
+    /* status updates are pushed from other throttles' commands, which must
+     * not stall on a slow client */
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
 }
 
 /*
- * ThrottleFlow::entry()
+ * ThrottleFlow::send_status()
  */
-StateFlowBase::Action ThrottleFlow::entry()
+void ThrottleFlow::send_status(ServerTrain *train)
 {
-    string init = Defs::get_init_string();
-
-    return write_repeated(&selectHelper, fd, init.data(), init.length(),
-                          STATE(data_sent));
+    if (writer.full())
+    {
+        /* the client stopped reading; the next update supersedes this one */
+        ++droppedWrites;
+        return;
+    }
+    for (TrainEntry &e : trains)
+    {
+        if (e.train == train)
+        {
+            /* the multi throttle commands we parse all use throttle 'T' */
+            char line[ServerTrain::STATUS_SIZE];
+            write_line(line, train->format_status(
+                e.type == SECONDARY ? 'S' : 'T', line));
+        }
+    }
 }
 
 /*
- * ThrottleFlow::data_sent()
+ * ThrottleFlow::acquire_train()
  */
-StateFlowBase::Action ThrottleFlow::data_sent()
+void ThrottleFlow::acquire_train(CommandType type, LocoAddress address)
 {
-    return read_single(&selectHelper, fd, readRaw, sizeof(readRaw),
-                      STATE(data_received));
+    ServerTrain *train = server->train(address);
+    for (TrainEntry &e : trains)
+    {
+        if (e.type == type && e.train == train)
+        {
+            return;
+        }
+    }
+    bool added = !controls(train);
+    trains.push_back({type, train});
+    if (added)
+    {
+        /* the server train knows the connection only once */
+        train->add_throttle(this);
+    }
+
+    /* bring the new throttle up to date */
+    char line[ServerTrain::STATUS_SIZE];
+    write_line(line, train->format_status(type == SECONDARY ? 'S' : 'T', line));
 }
 
 /*
- * ThrottleFlow::data_received()
+ * ThrottleFlow::release_train()
  */
-StateFlowBase::Action ThrottleFlow::data_received()
+void ThrottleFlow::release_train(CommandType type, ServerTrain *train)
 {
-    if (selectHelper.hasError_)
+    for (auto it = trains.begin(); it != trains.end(); ++it)
     {
-        /* remote throttle has closed the connection */
-        printf("WiThrottle connection closed\n");
-        return delete_this();
+        if (it->type == type && it->train == train)
+        {
+            trains.erase(it);
+            if (!controls(train))
+            {
+                train->remove_throttle(this);
+            }
+            return;
+        }
     }
+}
 
-    printf("WiThrottle strraw: %.*s\n",
-           sizeof(readRaw) - selectHelper.remaining_, readRaw);
-
-    data.append(readRaw, sizeof(readRaw) - selectHelper.remaining_);
-    if (data.find('\n' != string::npos))
+/*
+ * ThrottleFlow::controls()
+ */
+bool ThrottleFlow::controls(ServerTrain *train)
+{
+    for (TrainEntry &e : trains)
     {
-        bool result;
-        do
+        if (e.train == train)
         {
-            result = parse();
-            if (result)
-            {
-                dispatcher.send(command);
-                command = dispatcher.alloc();
-            }
-        } while (result);
+            return true;
+        }
     }
+    return false;
+}
+
+/*
+ * ThrottleFlow::entry()
+ */
+StateFlowBase::Action ThrottleFlow::entry()
+{
+    string init = Defs::get_init_string();
+    write_line(init.data(), init.length());
+
+    return call_immediately(STATE(read_more));
+}
 
+/*
+ * ThrottleFlow::read_more()
+ */
+StateFlowBase::Action ThrottleFlow::read_more()
+{
     return read_single(&selectHelper, fd, readRaw, sizeof(readRaw),
                        STATE(data_received));
 }
 
 /*
- * ThrottleFlow::parse()
+ * ThrottleFlow::data_received()
  */
-bool ThrottleFlow::parse()
+StateFlowBase::Action ThrottleFlow::data_received()
 {
-    const char *c_str = data.c_str();
-    printf("WiThrottle stream: %s\n", c_str + dataIndex);
+    if (selectHelper.hasError_)
+    {
+        /* remote throttle has closed the connection */
+        printf("WiThrottle connection closed\n");
+        return call_immediately(STATE(closing));
+    }
+
+    const char *raw = readRaw;
+    size_t len = sizeof(readRaw) - selectHelper.remaining_;
 
-    do
+    while (parser.parse(&raw, &len, command->data()))
     {
-        switch (state)
+        switch (command->data()->commandType)
         {
-            case STATE_COMMAND:
-                if (data.length() < 2)
-                {
-                    /* need more data first */
-                    return false;
-                }
-                parse_command();
-                break;
-            case STATE_MULTI_TYPE:
-                parse_multi_type();
-                break;
-            case STATE_TRAIN:
-                parse_train();
+            case HEARTBEAT:
+            case SET_NAME:
+                write_line("*10\n\n", 5);
                 break;
-            case STATE_SUBCOMMAND:
-                if (parse_subcommand())
-                {
-                    return true;
-                }
-                break;
-            case STATE_PAYLOAD:
             default:
-            case STATE_NEXT:
-                if (data[0] == '\n')
-                {
-                    dataIndex = 0;
-                    state = STATE_COMMAND;
-                }
-                data.erase(0, 1);
                 break;
         }
-    } while (data.length());
+        command->set_done(pendingCommands.new_child());
+        dispatcher.send(command);
+        command = dispatcher.alloc();
+    }
 
-    return false;
+    if (writer.full())
+    {
+        /* do not read more requests than the client reads replies */
+        writer.flush(this);
+        return wait_and_call(STATE(read_more));
+    }
+    return call_immediately(STATE(read_more));
 }
 
 /*
- * ThrottleFlow::parse_command()
+ * ThrottleFlow::closing()
  */
-void ThrottleFlow::parse_command()
+StateFlowBase::Action ThrottleFlow::closing()
 {
-    command->data()->commandType = (CommandType)data[0];
+    /* commands from the last read may still be processed */
+    pendingCommands.maybe_done();
+    return wait_and_call(STATE(commands_done));
+}
 
-    switch (data[0])
+/*
+ * ThrottleFlow::commands_done()
+ */
+StateFlowBase::Action ThrottleFlow::commands_done()
+{
+    while (!trains.empty())
     {
-        default:
-        case SECONDARY:
-        case HEX_PACKET:
-        case PANEL:
-        case ROSTER:
-        case QUIT:
-            state = STATE_NEXT;
-            return;
-        case MULTI:
-            state = data[1] == 'T' ? STATE_MULTI_TYPE : STATE_NEXT;
-            data.erase(0, 1);
-            break;
-        case PRIMARY:
-            state = STATE_SUBCOMMAND;
-            break;
-        case HEARTBEAT:
-        case SET_NAME:
-            write(fd, "*10\n\n", 5);
-        case SET_ID:
-            state = STATE_PAYLOAD;
-            break;
+        release_train(trains.back().type, trains.back().train);
     }
+    writer.flush(this);
+    return wait_and_call(STATE(flushed));
+}
 
-    data.erase(0, 1);
+/*
+ * ThrottleFlow::flushed()
+ */
+StateFlowBase::Action ThrottleFlow::flushed()
+{
+    return delete_this();
 }
 
 /*
- * ThrottleFlow::parse_multi_type()
+ * ThrottleFlow::Writer::Writer()
  */
-void ThrottleFlow::parse_multi_type()
+ThrottleFlow::Writer::Writer(ThrottleFlow *throttle)
+    : StateFlowBase(throttle->server)
+    , throttle(throttle)
+    , done(nullptr)
+    , selectHelper(this)
+    , busy(0)
+    , failed(0)
 {
-    switch (data[0])
+}
+
+/*
+ * ThrottleFlow::Writer::write()
+ */
+void ThrottleFlow::Writer::write(const char *data, size_t len)
+{
+    if (failed)
     {
-        default:
-            state = STATE_NEXT;
-            return;
-        case ACTION:
-        case ADD:
-        case REMOVE:
-            state = STATE_TRAIN;
-            command->data()->commandMultiType = (CommandMultiType)data[0];
-            break;
+        ++throttle->droppedWrites;
+        return;
+    }
+    queued.append(data, len);
+    if (!busy)
+    {
+        busy = 1;
+        start_flow(STATE(send));
     }
-
-    data.erase(0, 1);
 }
 
 /*
- * ThrottleFlow::parse_train()
+ * ThrottleFlow::Writer::flush()
  */
-void ThrottleFlow::parse_train()
+void ThrottleFlow::Writer::flush(Notifiable *done)
 {
-    size_t end = data.find("<;>");
-
-    switch (end)
+    if (!busy)
     {
-        case string::npos:
-        case 1:
-            if (data[0] == '*')
-            {
-                break;
-            }
-        case 0:
-            /* invalid string */
-            state = STATE_NEXT;
-            return;
+        done->notify();
+        return;
     }
-
-    command->data()->train.assign(data, 0, end);
-    data.erase(0, end + 3);
-    state = STATE_SUBCOMMAND;
+    this->done = done;
 }
 
 /*
- * ThrottleFlow::parse_subcommand()
+ * ThrottleFlow::Writer::send()
  */
-bool ThrottleFlow::parse_subcommand()
+StateFlowBase::Action ThrottleFlow::Writer::send()
 {
-    switch (data[0])
+    if (selectHelper.hasError_)
     {
-        default:
-        case VELOCITY:
-        case ESTOP:
-        case FUNCTION:
-        case FORCE:
-        case DIRECTION:
-        case RELEASE:
-        case DISPATCH:
-        case ADDR_SHORT:
-        case ADDR_ROSTER:
-        case CONSIST:
-        case CONSIST_LEAD:
-        case IDLE:
-        case SS_MODE:
-        case MOMENTARY:
-        case QUERY:
-            state = STATE_NEXT;
-            return false;
-        case ADDR_LONG:
-            state = STATE_PAYLOAD;
-            break;
+        /* the connection is gone */
+        failed = 1;
+        queued.clear();
     }
-
-    command->data()->commandSubType = (CommandSubType)data[0];
-    data.erase(0, 1);
-
-    size_t end = data.find('\n');
-
-    switch (end)
+    if (queued.empty())
     {
-        case string::npos:
-            /* invalid payload */
-            state = STATE_NEXT;
-            return false;
+        busy = 0;
+        if (done)
+        {
+            Notifiable *d = done;
+            done = nullptr;
+            d->notify();
+        }
+        return exit();
     }
-
-    command->data()->payload.assign(data, 0, end);
-    data.erase(0, end);
-    state = STATE_COMMAND;
-    return true;
+    sending.swap(queued);
+    queued.clear();
+    return write_repeated(&selectHelper, throttle->fd, sending.data(),
+                          sending.size(), STATE(send));
 }
 
 } /* namespace withrottle */
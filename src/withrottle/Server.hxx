@@ -28,16 +28,20 @@
 #ifndef _WITHROTTLE_SERVER_HXX_
 #define _WITHROTTLE_SERVER_HXX_
 
-#include <string>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "executor/Dispatcher.hxx"
 #include "executor/Service.hxx"
 #include "openlcb/TractionThrottle.hxx"
 #include "utils/socket_listener.hxx"
+#include "withrottle/CommandParser.hxx"
 #include "withrottle/Defs.hxx"
 #include "withrottle/ServerCommand.hxx"
 #include "withrottle/ServerCommandLoco.hxx"
+#include "withrottle/ServerTrain.hxx"
 
 namespace withrottle
 {
@@ -64,12 +68,10 @@ public:
     {
     }
 
-    /** Destructor.
+    /** Destructor. Clients should have disconnected before the server is
+     * destroyed.
      */
-    ~Server()
-    {
-        listener.shutdown();
-    }
+    ~Server();
 
     /** Start the server.
      */
@@ -77,11 +79,26 @@ public:
     {
     }
 
+    /** Serves a throttle on an already connected socket.
+     * @param fd socket descriptor, ownership is transferred to the server
+     */
+    void add_connection(int fd);
+
+    /** Looks up a locomotive, creating its state on first use. Must be
+     * called on the server executor.
+     * @param address locomotive address
+     * @return shared state of the locomotive
+     */
+    ServerTrain *train(LocoAddress address);
+
 private:
     /** A new throttle connection is made.
      * @param fd socket descriptor
      */
-    void on_new_connection(int fd);
+    void on_new_connection(int fd)
+    {
+        add_connection(fd);
+    }
 
     /** The executor that will run the WiThrottle flows. */
     Executor<1> executor;
@@ -92,9 +109,16 @@ private:
     /** listen socket for new connections */
     SocketListener listener;
 
+    /** Locomotives controlled by any of the throttles, keyed by the address
+     * and address type. Entries live as long as the server. */
+    std::map<uint16_t, ServerTrain *> trains;
+
     /** allow access from ThrottleFlow */
     friend class ThrottleFlow;
 
+    /** allow access from ServerTrain */
+    friend class ServerTrain;
+
     DISALLOW_COPY_AND_ASSIGN(Server);
 };
 
@@ -104,11 +128,10 @@ class ThrottleFlow : public StateFlowBase
 {
 public:
     /** Constructor.
-     * @param service service this flow belongs to
+     * @param server server this flow belongs to
      * @param fd socket descriptor of throttle connection.
-     * @param node OpenLCB node that proxies our throttles
      */
-    ThrottleFlow(Server *server, int fd, openlcb::Node *node);
+    ThrottleFlow(Server *server, int fd);
 
     /** Destructor.
      */
@@ -125,46 +148,137 @@ public:
         start_flow(STATE(entry));
     }
 
-private:
-    /** Parse the incoming data.
-     * @return true if a fully parsed command has been found, else false
+    /** Sends data to the throttle without blocking. The data is queued
+     * behind everything sent earlier and goes out whole.
+     * @param data data to send
+     * @param len number of bytes to send
+     */
+    void write_line(const char *data, size_t len)
+    {
+        writer.write(data, len);
+    }
+
+    /** Sends the current state of a locomotive to each throttle of this
+     * connection that controls it. The update is dropped if more than
+     * MAX_QUEUED bytes are waiting, i.e. the client stopped reading.
+     * @param train locomotive
      */
-    bool parse();
+    void send_status(ServerTrain *train);
 
-    /** Parse the incoming data. */
-    void parse_command();
+private:
+    /** Maximum number of bytes waiting to be written to the socket. */
+    static constexpr size_t MAX_QUEUED = 2048;
 
-    /** Parse the incoming data. */
-    void parse_multi_type();
+    /** Writes the data queued by write_line() to the socket. This is the
+     * only writer of the socket, so the lines are never interleaved or cut.
+     */
+    class Writer : public StateFlowBase
+    {
+    public:
+        /** Constructor.
+         * @param throttle parent
+         */
+        Writer(ThrottleFlow *throttle);
+
+        /** Queues data to be sent.
+         * @param data data to send
+         * @param len number of bytes to send
+         */
+        void write(const char *data, size_t len);
+
+        /** Waits until all queued data was sent, or the connection failed.
+         * @param done notified when the writer is idle
+         */
+        void flush(Notifiable *done);
+
+        /** @return true if MAX_QUEUED or more bytes are waiting */
+        bool full()
+        {
+            return queued.size() >= MAX_QUEUED;
+        }
+
+    private:
+        /** Sends the data queued since the last write.
+         * @return next state is send()
+         */
+        StateFlowBase::Action send();
+
+        /** parent */
+        ThrottleFlow *throttle;
+
+        /** data waiting for the current write to complete */
+        string queued;
+
+        /** data of the current write */
+        string sending;
+
+        /** notified when the writer becomes idle */
+        Notifiable *done;
+
+        /** Helper for waiting on the socket to become writable */
+        StateFlowSelectHelper selectHelper;
+
+        /** a write is in progress */
+        unsigned busy : 1;
+
+        /** writing to the socket failed, all further data is dropped */
+        unsigned failed : 1;
+    };
+
+    /** A locomotive controlled by one of the throttles of this connection.
+     */
+    struct TrainEntry
+    {
+        CommandType type; /**< PRIMARY, SECONDARY or MULTI */
+        ServerTrain *train; /**< the locomotive */
+    };
 
-    /** Parse the incoming data. */
-    void parse_train();
+    /** Starts controlling a locomotive.
+     * @param type throttle (PRIMARY, SECONDARY or MULTI) to add it to
+     * @param address address of the locomotive
+     */
+    void acquire_train(CommandType type, LocoAddress address);
 
-    /** Parse the incoming data.
-     * @return true if a fully parsed command has been found, else false
+    /** Stops controlling a locomotive.
+     * @param type throttle (PRIMARY, SECONDARY or MULTI) to remove it from
+     * @param train locomotive to release
      */
-    bool parse_subcommand();
+    void release_train(CommandType type, ServerTrain *train);
 
-    /** Parse the incoming data. */
-    void parse_multi();
+    /** @param train locomotive to look for
+     * @return true if any of the throttles of this connection controls train
+     */
+    bool controls(ServerTrain *train);
 
     /** Beginning of state flow.
-     * @return next state is data_sent()
+     * @return next state is read_more()
      */
     StateFlowBase::Action entry();
 
-    /** Data sent successfully.
+    /** Reads the next requests from the throttle.
      * @return next state is data_received()
      */
-    StateFlowBase::Action data_sent();
+    StateFlowBase::Action read_more();
 
     /** Process read data.
-     * @return next state is data_received()
+     * @return next state is read_more()
      */
     StateFlowBase::Action data_received();
 
-    /**< OpenLCB throttle instance */
-    openlcb::TractionThrottle olcbThrottle;
+    /** Connection closed, wait for the queued commands to finish.
+     * @return next state is commands_done()
+     */
+    StateFlowBase::Action closing();
+
+    /** All commands are processed, releases the locomotives.
+     * @return next state is flushed()
+     */
+    StateFlowBase::Action commands_done();
+
+    /** The writer is idle.
+     * @return delete_this()
+     */
+    StateFlowBase::Action flushed();
 
     /** reference to parent server */
     Server *server;
@@ -174,20 +288,26 @@ private:
     LocoAddress address; /**< primary locomitve addres */
     LocoAddress secondaryAddress; /**< secondary locomotive address */
 
+    /** locomotives controlled by the throttles of this connection */
+    std::vector<TrainEntry> trains;
+
     /** socket descriptor of throttle connection */
     int fd;
 
-    /** read data buffer */
-    char readRaw[128];
+    /** number of writes dropped because the client did not read */
+    unsigned droppedWrites;
+
+    /** the only writer of the socket */
+    Writer writer;
 
-    /** agrigate pre-processed stream data */
-    string data;
+    /** has a child for every command being processed */
+    BarrierNotifiable pendingCommands;
 
-    /** data index for parsing */
-    size_t dataIndex;
+    /** read data buffer */
+    char readRaw[128];
 
-    /** Current state of parsing the data */
-    ServerState state;
+    /** turns the incoming stream into commands */
+    CommandParser parser;
 
     /** Helper for waiting on data from a file descriptor */
     StateFlowSelectHelper selectHelper;
@@ -211,15 +331,6 @@ private:
     friend class ServerCommandLoco;
 };
 
-/*
- * Server::on_new_connection()
- */
-inline void Server::on_new_connection(int fd)
-{
-    ThrottleFlow *flow = new ThrottleFlow(this, fd, node);
-    flow->start();
-}
-
 } /* namespace withrottle */
 
 #endif /* _WITHROTTLE_SERVER_HXX_ */
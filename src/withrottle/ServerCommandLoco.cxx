@@ -28,6 +28,8 @@
 #include "withrottle/ServerCommandLoco.hxx"
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #include "withrottle/Server.hxx"
 
@@ -63,25 +65,121 @@ StateFlowBase::Action ServerCommandLoco::entry()
         default:
             return release_and_exit();
         case ADDR_LONG:
-            return call_immediately(STATE(address_long));
+        case ADDR_SHORT:
+            return call_immediately(STATE(address));
+        case VELOCITY:
+        case ESTOP:
+        case DIRECTION:
+        case IDLE:
+        case RELEASE:
+        case DISPATCH:
+            return call_immediately(STATE(control));
     }
 }
 
 /*
- * ServerCommandLoco::address_long()
+ * ServerCommandLoco::address()
  */
-StateFlowBase::Action ServerCommandLoco::address_long()
+StateFlowBase::Action ServerCommandLoco::address()
 {
-    unsigned long value = strtoul(message()->data()->payload.c_str(), NULL, 0);
+    ThrottleCommand *command = message()->data();
+    errno = 0;
+    unsigned long value = strtoul(command->payload, NULL, 10);
 
-    if ((value == 0 && errno == EINVAL) || value > 9999)
+    if (errno || value > 9999 ||
+        (command->commandSubType == ADDR_SHORT && value > 127))
     {
         return release_and_exit();
     }
 
-    printf("loco: %lu\n", value);
+    if (command->commandType != MULTI)
+    {
+        /* the primary and secondary throttles control one locomotive each */
+        for (size_t i = throttle->trains.size(); i > 0; --i)
+        {
+            ThrottleFlow::TrainEntry e = throttle->trains[i - 1];
+            if (e.type == command->commandType)
+            {
+                throttle->release_train(e.type, e.train);
+            }
+        }
+    }
+
+    LocoAddress address;
+    address.address = value;
+    address.addressType = command->commandSubType == ADDR_LONG;
+    address.inUse = 1;
+    throttle->acquire_train(command->commandType, address);
     return release_and_exit();
 }
 
-} /* namespace withrottle */
+/*
+ * ServerCommandLoco::control()
+ */
+StateFlowBase::Action ServerCommandLoco::control()
+{
+    ThrottleCommand *command = message()->data();
+    /* iterate backwards so that released trains may be removed */
+    for (size_t i = throttle->trains.size(); i > 0; --i)
+    {
+        ThrottleFlow::TrainEntry e = throttle->trains[i - 1];
+        ServerTrain *train = e.train;
+        if (!matches(e.type, train))
+        {
+            continue;
+        }
+        switch (command->commandSubType)
+        {
+            case VELOCITY:
+            {
+                int speed = atoi(command->payload);
+                if (speed < 0)
+                {
+                    train->set_emergencystop(throttle);
+                }
+                else
+                {
+                    train->set_speed(speed, throttle);
+                }
+                break;
+            }
+            case ESTOP:
+                train->set_emergencystop(throttle);
+                break;
+            case DIRECTION:
+                train->set_direction(command->payload[0] != '0', throttle);
+                break;
+            case IDLE:
+                train->set_speed(0, throttle);
+                break;
+            case RELEASE:
+            case DISPATCH:
+                throttle->release_train(e.type, train);
+                break;
+            default:
+                break;
+        }
+    }
+    return release_and_exit();
+}
 
+/*
+ * ServerCommandLoco::matches()
+ */
+bool ServerCommandLoco::matches(CommandType type, ServerTrain *train)
+{
+    ThrottleCommand *command = message()->data();
+    if (type != command->commandType)
+    {
+        /* belongs to another throttle of the same connection */
+        return false;
+    }
+    if (command->commandType != MULTI)
+    {
+        return true;
+    }
+    return strcmp(command->train, "*") == 0 ||
+           strcmp(command->train, train->name()) == 0;
+}
+
+} /* namespace withrottle */
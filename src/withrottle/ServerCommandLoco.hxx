@@ -33,6 +33,9 @@
 namespace withrottle
 {
 
+/* forward declaration */
+class ServerTrain;
+
 /** WiThrottle server command handler base object for multi, primary, and
  * secondary locomotive.
  */
@@ -54,10 +57,22 @@ private:
      */
     StateFlowBase::Action entry() override;
 
-    /** Handle a DCC long address sub-command.
-     * @return next state is
+    /** Handle a DCC long or short address sub-command.
+     * @return next state is release_and_exit()
+     */
+    StateFlowBase::Action address();
+
+    /** Handle a control sub-command for the addressed locomotives.
+     * @return next state is release_and_exit()
+     */
+    StateFlowBase::Action control();
+
+    /** Determine if a command applies to a locomotive of the throttle.
+     * @param type throttle (PRIMARY, SECONDARY or MULTI) controlling train
+     * @param train locomotive to check
+     * @return true if the current command is for train
      */
-    StateFlowBase::Action address_long();
+    bool matches(CommandType type, ServerTrain *train);
 
     DISALLOW_COPY_AND_ASSIGN(ServerCommandLoco);
 };
@@ -0,0 +1,280 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file withrottle/ServerTrain.cxx
+ *
+ * Locomotive state shared by all WiThrottle clients controlling it.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#include "withrottle/ServerTrain.hxx"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "openlcb/TractionDefs.hxx"
+#include "withrottle/Server.hxx"
+
+namespace withrottle
+{
+
+/*
+ * ServerTrain::ServerTrain()
+ */
+ServerTrain::ServerTrain(Server *server, LocoAddress address)
+    : ::Timer(server->executor.active_timers())
+    , server_(server)
+    , throttle_(server->node)
+    , assignDone_(this)
+    , origin_(nullptr)
+    , flushDone_(nullptr)
+    , nodeId_(openlcb::TractionDefs::train_node_id_from_legacy(
+          address.addressType ? dcc::TrainAddressType::DCC_LONG_ADDRESS
+                              : dcc::TrainAddressType::DCC_SHORT_ADDRESS,
+          address.address))
+    , lastUpdate_(0)
+    , requests_(0)
+    , updates_(0)
+    , speed_(0)
+    , forward_(1)
+    , estop_(0)
+    , scheduled_(0)
+    , assigning_(0)
+    , pending_(0)
+{
+    snprintf(name_, sizeof(name_), "%c%u", address.addressType ? 'L' : 'S',
+             (unsigned)address.address);
+}
+
+/*
+ * ServerTrain::~ServerTrain()
+ */
+ServerTrain::~ServerTrain()
+{
+    HASSERT(!scheduled_);
+}
+
+/*
+ * ServerTrain::add_throttle()
+ */
+void ServerTrain::add_throttle(ThrottleFlow *throttle)
+{
+    throttles_.push_back(throttle);
+    if (throttles_.size() == 1)
+    {
+        assigning_ = 1;
+        send_throttle_command(&assignDone_,
+            openlcb::TractionThrottleCommands::ASSIGN_TRAIN, nodeId_);
+    }
+}
+
+/*
+ * ServerTrain::remove_throttle()
+ */
+void ServerTrain::remove_throttle(ThrottleFlow *throttle)
+{
+    auto it = std::find(throttles_.begin(), throttles_.end(), throttle);
+    if (it == throttles_.end())
+    {
+        return;
+    }
+    throttles_.erase(it);
+    if (origin_ == throttle)
+    {
+        origin_ = nullptr;
+    }
+    if (throttles_.empty())
+    {
+        send_throttle_command(EmptyNotifiable::DefaultInstance(),
+            openlcb::TractionThrottleCommands::RELEASE_TRAIN);
+    }
+}
+
+/*
+ * ServerTrain::set_speed()
+ */
+void ServerTrain::set_speed(unsigned speed, ThrottleFlow *origin)
+{
+    speed_ = std::min(speed, 126u);
+    schedule(origin);
+}
+
+/*
+ * ServerTrain::set_direction()
+ */
+void ServerTrain::set_direction(bool forward, ThrottleFlow *origin)
+{
+    forward_ = forward ? 1 : 0;
+    schedule(origin);
+}
+
+/*
+ * ServerTrain::set_emergencystop()
+ */
+void ServerTrain::set_emergencystop(ThrottleFlow *origin)
+{
+    speed_ = 0;
+    estop_ = 1;
+    schedule(origin);
+}
+
+/*
+ * ServerTrain::flush()
+ */
+void ServerTrain::flush(Notifiable *done)
+{
+    if (!scheduled_)
+    {
+        done->notify();
+        return;
+    }
+    HASSERT(!flushDone_);
+    flushDone_ = done;
+}
+
+/*
+ * ServerTrain::schedule()
+ */
+void ServerTrain::schedule(ThrottleFlow *origin)
+{
+    ++requests_;
+    origin_ = origin;
+    if (scheduled_)
+    {
+        /* coalesced into the pending update */
+        return;
+    }
+    long long now = os_get_time_monotonic();
+    if (now - lastUpdate_ >= UPDATE_PERIOD)
+    {
+        update();
+        return;
+    }
+    scheduled_ = 1;
+    start_absolute(lastUpdate_ + UPDATE_PERIOD);
+}
+
+/*
+ * ServerTrain::timeout()
+ */
+long long ServerTrain::timeout()
+{
+    scheduled_ = 0;
+    update();
+    if (flushDone_)
+    {
+        Notifiable *done = flushDone_;
+        flushDone_ = nullptr;
+        done->notify();
+    }
+    return NONE;
+}
+
+/*
+ * ServerTrain::update()
+ */
+void ServerTrain::update()
+{
+    lastUpdate_ = os_get_time_monotonic();
+
+    if (!assigning_ && throttle_.is_train_assigned())
+    {
+        if (estop_)
+        {
+            throttle_.set_emergencystop();
+            estop_ = 0;
+        }
+        else
+        {
+            openlcb::SpeedType speed;
+            speed.set_dcc_128((speed_ ? speed_ + 1 : 0) | (forward_ << 7));
+            throttle_.set_speed(speed);
+        }
+        ++updates_;
+        pending_ = 0;
+    }
+    else
+    {
+        /* sent by AssignDone once the train is ours */
+        pending_ = 1;
+    }
+
+    for (ThrottleFlow *t : throttles_)
+    {
+        if (t != origin_)
+        {
+            t->send_status(this);
+        }
+    }
+}
+
+/*
+ * ServerTrain::AssignDone::notify()
+ */
+void ServerTrain::AssignDone::notify()
+{
+    train_->server_->executor.add(this);
+}
+
+/*
+ * ServerTrain::AssignDone::run()
+ */
+void ServerTrain::AssignDone::run()
+{
+    train_->assigning_ = 0;
+    if (train_->pending_ && !train_->scheduled_)
+    {
+        train_->update();
+    }
+}
+
+/*
+ * ServerTrain::format_status()
+ */
+size_t ServerTrain::format_status(char throttle, char line[STATUS_SIZE])
+{
+    int len = snprintf(line, STATUS_SIZE, "M%cA%s<;>V%u\n\nM%cA%s<;>R%u\n\n",
+                       throttle, name_, (unsigned)speed_, throttle, name_,
+                       (unsigned)forward_);
+    HASSERT(len > 0 && len < STATUS_SIZE);
+    return len;
+}
+
+/*
+ * ServerTrain::send_throttle_command()
+ */
+template <class... Args>
+void ServerTrain::send_throttle_command(Notifiable *done, Args &&... args)
+{
+    Buffer<openlcb::TractionThrottleInput> *b = throttle_.alloc();
+    b->data()->reset(std::forward<Args>(args)...);
+    b->data()->done.reset(done);
+    throttle_.send(b);
+}
+
+} /* namespace withrottle */
@@ -0,0 +1,257 @@
+/** \copyright
+ * Copyright (c) 2026, agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file withrottle/ServerTrain.hxx
+ *
+ * Locomotive state shared by all WiThrottle clients controlling it.
+ *
+ * @author agent
+ * @date 19 Oct 2026
+ */
+
+#ifndef _WITHROTTLE_SERVERTRAIN_HXX_
+#define _WITHROTTLE_SERVERTRAIN_HXX_
+
+#include <vector>
+
+#include "executor/Timer.hxx"
+#include "openlcb/TractionThrottle.hxx"
+#include "withrottle/Defs.hxx"
+
+namespace withrottle
+{
+
+/* forward declaration */
+class Server;
+class ThrottleFlow;
+
+/** One locomotive controlled through the WiThrottle server. There is a single
+ * instance (and a single OpenLCB traction throttle) per locomotive, no matter
+ * how many clients are controlling or watching it.
+ *
+ * Control requests record the desired state. The state is then sent to the
+ * train once, and a status line is pushed to every client that did not
+ * originate the change. Updates go out at most once per UPDATE_PERIOD: the
+ * first request after a quiet period is sent immediately, while the requests
+ * arriving within the period are coalesced into a single update at its end.
+ */
+class ServerTrain : public ::Timer
+{
+public:
+    /** Minimum time between two updates sent to the train. */
+    static constexpr long long UPDATE_PERIOD = MSEC_TO_NSEC(50);
+
+    /** Size of the buffer for a status update sent to the clients. */
+    static constexpr int STATUS_SIZE = 48;
+
+    /** Constructor.
+     * @param server parent server
+     * @param address locomotive address
+     */
+    ServerTrain(Server *server, LocoAddress address);
+
+    /** Destructor. */
+    ~ServerTrain();
+
+    /** @return the name clients use for this locomotive, e.g. "L341" */
+    const char *name()
+    {
+        return name_;
+    }
+
+    /** Adds a client to the set of throttles controlling this locomotive.
+     * Assigns the OpenLCB throttle to the train for the first client.
+     * @param throttle client to add
+     */
+    void add_throttle(ThrottleFlow *throttle);
+
+    /** Removes a client from the set of throttles controlling this
+     * locomotive. Releases the train when the last client is gone.
+     * @param throttle client to remove
+     */
+    void remove_throttle(ThrottleFlow *throttle);
+
+    /** @return number of clients controlling this locomotive */
+    size_t throttle_count()
+    {
+        return throttles_.size();
+    }
+
+    /** Requests a new speed.
+     * @param speed WiThrottle speed step, 0..126
+     * @param origin client that sent the request
+     */
+    void set_speed(unsigned speed, ThrottleFlow *origin);
+
+    /** Requests a new direction.
+     * @param forward true for forward, false for reverse
+     * @param origin client that sent the request
+     */
+    void set_direction(bool forward, ThrottleFlow *origin);
+
+    /** Requests an emergency stop.
+     * @param origin client that sent the request
+     */
+    void set_emergencystop(ThrottleFlow *origin);
+
+    /** @return number of control requests received */
+    unsigned requests()
+    {
+        return requests_;
+    }
+
+    /** @return number of state updates sent to the train */
+    unsigned updates()
+    {
+        return updates_;
+    }
+
+    /** @return true if an update is waiting for the end of the period */
+    bool is_scheduled()
+    {
+        return scheduled_;
+    }
+
+    /** Waits for the update that is waiting for the end of the period.
+     * @param done notified once no update is scheduled
+     */
+    void flush(Notifiable *done);
+
+    /** Formats the current state as WiThrottle status lines.
+     * @param throttle the throttle identifier of the client, 'T' or 'S'
+     * @param line buffer to fill
+     * @return number of bytes in line
+     */
+    size_t format_status(char throttle, char line[STATUS_SIZE]);
+
+private:
+    /** Notified by the traction throttle when the train assignment is done,
+     * on the executor of the throttle. Hands the completion over to the
+     * server executor.
+     */
+    class AssignDone : public Executable
+    {
+    public:
+        /** Constructor.
+         * @param train parent
+         */
+        AssignDone(ServerTrain *train)
+            : train_(train)
+        {
+        }
+
+        /** Schedules run() on the server executor. */
+        void notify() override;
+
+        /** Sends the state requested while the train was being assigned. */
+        void run() override;
+
+    private:
+        /** parent */
+        ServerTrain *train_;
+    };
+
+    /** Called at the end of the update period.
+     * @return NONE
+     */
+    long long timeout() override;
+
+    /** Sends the update now or at the end of the update period.
+     * @param origin client that sent the request
+     */
+    void schedule(ThrottleFlow *origin);
+
+    /** Sends the requested state to the train and the clients. If the train
+     * is not assigned yet, the state stays pending and goes out when the
+     * assignment completes.
+     */
+    void update();
+
+    /** Sends a command to the OpenLCB throttle without waiting for it to
+     * complete.
+     * @param done notified when the command completed
+     * @param args arguments for TractionThrottleInput::reset()
+     */
+    template <class... Args>
+    void send_throttle_command(Notifiable *done, Args &&... args);
+
+    /** parent server */
+    Server *server_;
+
+    /** traction throttle talking to the train node */
+    openlcb::TractionThrottle throttle_;
+
+    /** hands the assignment completion to the server executor */
+    AssignDone assignDone_;
+
+    /** clients controlling this locomotive */
+    std::vector<ThrottleFlow *> throttles_;
+
+    /** client that made the latest request; does not get a status echo */
+    ThrottleFlow *origin_;
+
+    /** notified after the scheduled update went out */
+    Notifiable *flushDone_;
+
+    /** OpenLCB node ID of the train */
+    openlcb::NodeID nodeId_;
+
+    /** time of the last update sent */
+    long long lastUpdate_;
+
+    /** number of control requests received */
+    unsigned requests_;
+
+    /** number of state updates sent to the train */
+    unsigned updates_;
+
+    /** requested speed step, 0..126 */
+    uint8_t speed_;
+
+    /** requested direction */
+    uint8_t forward_ : 1;
+
+    /** an emergency stop was requested */
+    uint8_t estop_ : 1;
+
+    /** the timer is running for a pending update */
+    uint8_t scheduled_ : 1;
+
+    /** an ASSIGN_TRAIN command is in flight */
+    uint8_t assigning_ : 1;
+
+    /** the requested state has not been sent to the train yet */
+    uint8_t pending_ : 1;
+
+    /** client facing name of the locomotive */
+    char name_[8];
+
+    DISALLOW_COPY_AND_ASSIGN(ServerTrain);
+};
+
+} /* namespace withrottle */
+
+#endif /* _WITHROTTLE_SERVERTRAIN_HXX_ */